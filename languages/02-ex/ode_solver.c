@@ -18,6 +18,84 @@ static void M_DECL errorCallBack(void*       data,
     fprintf(stderr, "❌ Erro [%ld]: %s\n", (long)offset, msg);
 }
 
+/* ============================================
+ * Amostragem densa de dsolve/numeric
+ * ============================================ */
+
+/* Saída de dsolve(..., numeric, output = Array([...])) numa única
+   chamada: o Maple integra sobre toda a grade e devolve a matriz
+   (t, x(t), y(t), ...) em float[8] C_order, que o C lê direto do
+   bloco de dados, sem uma chamada dsol(t) por ponto.  `vars` é uma
+   lista e define a ordem das colunas depois de t. */
+typedef struct
+{
+    ALGEB   rtable; /* Matrix do Maple, protegida do GC */
+    double* data;   /* rows x cols; linha i = (t_i, x_i, y_i, ...) */
+    M_INT   rows;
+    M_INT   cols;
+} OdeGrid;
+
+static ALGEB ode_grid_proc = NULL;
+
+static int ode_grid_sample(MKernelVector kv,
+                           ALGEB         sys,
+                           ALGEB         vars,
+                           double        t0,
+                           double        t1,
+                           int           n,
+                           OdeGrid*      grid)
+{
+    ALGEB m;
+
+    grid->rtable = NULL;
+    grid->data   = NULL;
+    grid->rows = grid->cols = 0;
+
+    if(!ode_grid_proc)
+    {
+        ode_grid_proc = EvalMapleStatement(
+            kv,
+            "proc(sys, vars, a, b, n) "
+            "    local S, H, c, i, v; "
+            "    S := dsolve(sys, {op(vars)}, numeric, output = Array("
+            "        [seq(a + (b - a)*(i - 1)/(n - 1), i = 1..n)])); "
+            "    H := convert(S[1, 1], list); "
+            "    c := [1, seq(ListTools:-Search(v, H), v = vars)]; "
+            "    Matrix(S[2, 1][.., c], datatype = float[8], "
+            "           order = C_order) "
+            "end proc:");
+        if(!ode_grid_proc)
+            return 0;
+        MapleGcProtect(kv, ode_grid_proc);
+    }
+
+    m = EvalMapleProc(kv,
+                      ode_grid_proc,
+                      5,
+                      sys,
+                      vars,
+                      ToMapleFloat(kv, t0),
+                      ToMapleFloat(kv, t1),
+                      ToMapleInteger(kv, n));
+    if(!m || !IsMapleRTable(kv, m))
+        return 0;
+
+    MapleGcProtect(kv, m);
+    grid->rtable = m;
+    grid->data   = (double*)RTableDataBlock(kv, m);
+    grid->rows   = RTableUpperBound(kv, m, 1);
+    grid->cols   = RTableUpperBound(kv, m, 2);
+    return 1;
+}
+
+static void ode_grid_free(MKernelVector kv, OdeGrid* grid)
+{
+    if(grid->rtable)
+        MapleGcAllow(kv, grid->rtable);
+    grid->rtable = NULL;
+    grid->data   = NULL;
+}
+
 /* ============================================
  * EDO de Primeira Ordem
  * ============================================ */
@@ -33,23 +111,33 @@ void solve_first_order_ode(MKernelVector kv)
     printf("Solução analítica:\n");
     MapleALGEB_Printf(kv, "%a\n\n", solution);
 
-    // Resolver numericamente
+    // Resolver numericamente: o dsolve numérico da amostragem densa
+    // já usa o rkf45 (padrão para problemas de valor inicial), então
+    // não há um dsol separado para resolver o sistema de novo
     printf("Solução numérica (método Runge-Kutta):\n");
-    ALGEB numeric = EvalMapleStatement(
-        kv,
-        "dsol := dsolve({diff(y(x), x) = x + y(x), y(0) = 1}, "
-        "y(x), numeric, method=rkf45);");
 
-    // Avaliar em pontos específicos
+    // Avaliar em pontos específicos (x = 0, 0.5, ..., 2)
     printf("\nValores em pontos específicos:\n");
-    for(double x = 0.0; x <= 2.0; x += 0.5)
+    OdeGrid grid;
+    if(!ode_grid_sample(kv,
+                        EvalMapleStatement(
+                            kv,
+                            "{diff(y(x), x) = x + y(x), y(0) = 1}:"),
+                        EvalMapleStatement(kv, "[y(x)]:"),
+                        0.0,
+                        2.0,
+                        5,
+                        &grid))
     {
-        char cmd[256];
-        sprintf(cmd, "dsol(%.1f);", x);
-        ALGEB point = EvalMapleStatement(kv, cmd);
-        printf("x = %.1f: ", x);
-        MapleALGEB_Printf(kv, "%a\n", point);
+        fprintf(stderr, "Falha na amostragem densa\n");
+        return;
     }
+    for(M_INT i = 0; i < grid.rows; i++)
+    {
+        const double* row = grid.data + i * grid.cols;
+        printf("x = %.1f: y = %.10f\n", row[0], row[1]);
+    }
+    ode_grid_free(kv, &grid);
 }
 
 /* ============================================
@@ -69,9 +157,6 @@ void solve_system_odes(MKernelVector kv)
         "       diff(y(t), t) = -y(t) + 0.02*x(t)*y(t), "
         "       x(0) = 40, y(0) = 9}:");
 
-    ALGEB sol = EvalMapleStatement(
-        kv, "dsol := dsolve(sys, {x(t), y(t)}, numeric);");
-
     printf("Evolução temporal do sistema:\n");
     printf("%-10s %-15s %-15s\n",
            "t",
@@ -79,13 +164,26 @@ void solve_system_odes(MKernelVector kv)
            "y(t) [Predador]");
     printf("-------------------------------------------\n");
 
-    for(int i = 0; i <= 20; i++)
+    // t = 0, 1, ..., 20 numa única chamada ao dsolve; colunas na
+    // ordem (t, x(t), y(t))
+    OdeGrid grid;
+    if(!ode_grid_sample(kv,
+                        system,
+                        EvalMapleStatement(kv, "[x(t), y(t)]:"),
+                        0.0,
+                        20.0,
+                        21,
+                        &grid))
+    {
+        fprintf(stderr, "Falha na amostragem densa\n");
+        return;
+    }
+    for(M_INT i = 0; i < grid.rows; i++)
     {
-        char cmd[128];
-        sprintf(cmd, "dsol(%d);", i);
-        ALGEB point = EvalMapleStatement(kv, cmd);
-        MapleALGEB_Printf(kv, "%a\n", point);
+        const double* row = grid.data + i * grid.cols;
+        printf("%-10.1f %-15.6f %-15.6f\n", row[0], row[1], row[2]);
     }
+    ode_grid_free(kv, &grid);
 }
 
 /* ============================================
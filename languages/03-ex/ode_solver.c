@@ -3,6 +3,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <fcntl.h>
 
 #include "maplec.h"
 
@@ -20,6 +24,84 @@ static void M_DECL errorCallBack(void*       data,
     fprintf(stderr, "❌ Erro [%ld]: %s\n", (long)offset, msg);
 }
 
+/* ============================================
+ * Amostragem densa de dsolve/numeric
+ * ============================================ */
+
+/* Saída de dsolve(..., numeric, output = Array([...])) numa única
+   chamada: o Maple integra sobre toda a grade e devolve a matriz
+   (t, x(t), y(t), ...) em float[8] C_order, que o C lê direto do
+   bloco de dados, sem uma chamada dsol(t) por ponto.  `vars` é uma
+   lista e define a ordem das colunas depois de t. */
+typedef struct
+{
+    ALGEB   rtable; /* Matrix do Maple, protegida do GC */
+    double* data;   /* rows x cols; linha i = (t_i, x_i, y_i, ...) */
+    M_INT   rows;
+    M_INT   cols;
+} OdeGrid;
+
+static ALGEB ode_grid_proc = NULL;
+
+static int ode_grid_sample(MKernelVector kv,
+                           ALGEB         sys,
+                           ALGEB         vars,
+                           double        t0,
+                           double        t1,
+                           int           n,
+                           OdeGrid*      grid)
+{
+    ALGEB m;
+
+    grid->rtable = NULL;
+    grid->data   = NULL;
+    grid->rows = grid->cols = 0;
+
+    if(!ode_grid_proc)
+    {
+        ode_grid_proc = EvalMapleStatement(
+            kv,
+            "proc(sys, vars, a, b, n) "
+            "    local S, H, c, i, v; "
+            "    S := dsolve(sys, {op(vars)}, numeric, output = Array("
+            "        [seq(a + (b - a)*(i - 1)/(n - 1), i = 1..n)])); "
+            "    H := convert(S[1, 1], list); "
+            "    c := [1, seq(ListTools:-Search(v, H), v = vars)]; "
+            "    Matrix(S[2, 1][.., c], datatype = float[8], "
+            "           order = C_order) "
+            "end proc:");
+        if(!ode_grid_proc)
+            return 0;
+        MapleGcProtect(kv, ode_grid_proc);
+    }
+
+    m = EvalMapleProc(kv,
+                      ode_grid_proc,
+                      5,
+                      sys,
+                      vars,
+                      ToMapleFloat(kv, t0),
+                      ToMapleFloat(kv, t1),
+                      ToMapleInteger(kv, n));
+    if(!m || !IsMapleRTable(kv, m))
+        return 0;
+
+    MapleGcProtect(kv, m);
+    grid->rtable = m;
+    grid->data   = (double*)RTableDataBlock(kv, m);
+    grid->rows   = RTableUpperBound(kv, m, 1);
+    grid->cols   = RTableUpperBound(kv, m, 2);
+    return 1;
+}
+
+static void ode_grid_free(MKernelVector kv, OdeGrid* grid)
+{
+    if(grid->rtable)
+        MapleGcAllow(kv, grid->rtable);
+    grid->rtable = NULL;
+    grid->data   = NULL;
+}
+
 /* ============================================
  * EDO de Primeira Ordem
  * ============================================ */
@@ -35,23 +117,33 @@ void solve_first_order_ode(MKernelVector kv)
     printf("Solução analítica:\n");
     MapleALGEB_Printf(kv, "%a\n\n", solution);
 
-    // Resolver numericamente
+    // Resolver numericamente: o dsolve numérico da amostragem densa
+    // já usa o rkf45 (padrão para problemas de valor inicial), então
+    // não há um dsol separado para resolver o sistema de novo
     printf("Solução numérica (método Runge-Kutta):\n");
-    ALGEB numeric = EvalMapleStatement(
-        kv,
-        "dsol := dsolve({diff(y(x), x) = x + y(x), y(0) = 1}, "
-        "y(x), numeric, method=rkf45);");
 
-    // Avaliar em pontos específicos
+    // Avaliar em pontos específicos (x = 0, 0.5, ..., 2)
     printf("\nValores em pontos específicos:\n");
-    for(double x = 0.0; x <= 2.0; x += 0.5)
+    OdeGrid grid;
+    if(!ode_grid_sample(kv,
+                        EvalMapleStatement(
+                            kv,
+                            "{diff(y(x), x) = x + y(x), y(0) = 1}:"),
+                        EvalMapleStatement(kv, "[y(x)]:"),
+                        0.0,
+                        2.0,
+                        5,
+                        &grid))
     {
-        char cmd[256];
-        sprintf(cmd, "dsol(%.1f);", x);
-        ALGEB point = EvalMapleStatement(kv, cmd);
-        printf("x = %.1f: ", x);
-        MapleALGEB_Printf(kv, "%a\n", point);
+        fprintf(stderr, "Falha na amostragem densa\n");
+        return;
+    }
+    for(M_INT i = 0; i < grid.rows; i++)
+    {
+        const double* row = grid.data + i * grid.cols;
+        printf("x = %.1f: y = %.10f\n", row[0], row[1]);
     }
+    ode_grid_free(kv, &grid);
 }
 
 /* ============================================
@@ -71,9 +163,6 @@ void solve_system_odes(MKernelVector kv)
         "       diff(y(t), t) = -y(t) + 0.02*x(t)*y(t), "
         "       x(0) = 40, y(0) = 9}:");
 
-    ALGEB sol = EvalMapleStatement(
-        kv, "dsol := dsolve(sys, {x(t), y(t)}, numeric);");
-
     printf("Evolução temporal do sistema:\n");
     printf("%-10s %-15s %-15s\n",
            "t",
@@ -81,13 +170,355 @@ void solve_system_odes(MKernelVector kv)
            "y(t) [Predador]");
     printf("-------------------------------------------\n");
 
-    for(int i = 0; i <= 20; i++)
+    // t = 0, 1, ..., 20 numa única chamada ao dsolve; colunas na
+    // ordem (t, x(t), y(t))
+    OdeGrid grid;
+    if(!ode_grid_sample(kv,
+                        system,
+                        EvalMapleStatement(kv, "[x(t), y(t)]:"),
+                        0.0,
+                        20.0,
+                        21,
+                        &grid))
+    {
+        fprintf(stderr, "Falha na amostragem densa\n");
+        return;
+    }
+    for(M_INT i = 0; i < grid.rows; i++)
+    {
+        const double* row = grid.data + i * grid.cols;
+        printf("%-10.1f %-15.6f %-15.6f\n", row[0], row[1], row[2]);
+    }
+    ode_grid_free(kv, &grid);
+}
+
+/* ============================================
+ * Sistema de EDOs - caminho nativo
+ * ============================================ */
+
+/* O Maple deriva o lado direito do sistema uma vez e o emite como
+   C (CodeGeneration:-C); o código é compilado como biblioteca
+   compartilhada, carregado com dlopen e integrado por um
+   Dormand-Prince 5(4) em C, sem nenhuma chamada ao kernel por
+   passo.  Serve para varreduras com milhares de condições iniciais
+   do mesmo sistema. */
+
+#define ODE_MAX_DIM 16
+
+typedef void (*OdeRhs)(double t, const double* Y, double* dY);
+
+/* Gera o texto C de ode_rhs(t, Y, dY) para `sys` nas variáveis
+   `vars` (lista, na ordem de Y[0], Y[1], ...) e compila com $CC.
+   Fonte e .so ficam num diretório criado com mkdtemp (só nosso),
+   removido em qualquer saída. */
+static OdeRhs compile_ode_rhs(MKernelVector kv, ALGEB sys, ALGEB vars)
+{
+    static ALGEB codegen = NULL;
+    char         dir[] = "/tmp/ode_rhsXXXXXX";
+    char         src[sizeof dir + 8], lib[sizeof dir + 16];
+    char         cmd[512];
+    const char*  cc;
+    FILE*        fp;
+    void*        handle = NULL;
+    ALGEB        code;
+    int          fd, built;
+
+    if(!codegen)
+    {
+        codegen = EvalMapleStatement(
+            kv,
+            "proc(sys, vars, t) "
+            "    local k, S, F, de; "
+            "    S := [seq(vars[k] = :-Y[k - 1], k = 1..nops(vars))]; "
+            "    F := [seq(:-dY[k - 1] = subs(S, t = :-t, rhs(op("
+            "              select(de -> lhs(de) = diff(vars[k], t), "
+            "                     sys)))), k = 1..nops(vars))]; "
+            "    CodeGeneration:-C(F, output = string) "
+            "end proc:");
+        if(!codegen)
+            return NULL;
+        MapleGcProtect(kv, codegen);
+    }
+
+    code = EvalMapleProc(kv, codegen, 3, sys, vars,
+                         ToMapleName(kv, "t", TRUE));
+    if(!code || !IsMapleString(kv, code))
+        return NULL;
+
+    if(!mkdtemp(dir))
+        return NULL;
+    snprintf(src, sizeof src, "%s/rhs.c", dir);
+    snprintf(lib, sizeof lib, "%s/rhs.so", dir);
+
+    if((fd = open(src, O_WRONLY | O_CREAT | O_EXCL, 0600)) < 0
+       || !(fp = fdopen(fd, "w")))
+    {
+        if(fd >= 0)
+            close(fd);
+        unlink(src);
+        rmdir(dir);
+        return NULL;
+    }
+    fprintf(fp,
+            "#include <math.h>\n"
+            "void ode_rhs(double t, const double *Y, double *dY)\n"
+            "{\n(void)t;\n%s\n}\n",
+            MapleToString(kv, code));
+    fclose(fp);
+
+    cc = getenv("CC") ? getenv("CC") : "cc";
+    snprintf(cmd, sizeof cmd,
+             "%s -O2 -shared -fPIC -o %s %s -lm", cc, lib, src);
+    built = system(cmd) == 0;
+    if(!built)
+        fprintf(stderr, "Falha ao compilar %s\n", src);
+    else if(!(handle = dlopen(lib, RTLD_NOW | RTLD_LOCAL)))
+        fprintf(stderr, "dlopen: %s\n", dlerror());
+
+    unlink(src);
+    unlink(lib);
+    rmdir(dir);
+    return handle ? (OdeRhs)dlsym(handle, "ode_rhs") : NULL;
+}
+
+/* Tabela de Butcher do Dormand-Prince 5(4), usada por dopri5() e
+   pelo ensemble de osciladores */
+static const double c2 = 1.0 / 5, c3 = 3.0 / 10, c4 = 4.0 / 5,
+                    c5 = 8.0 / 9;
+static const double a21 = 1.0 / 5;
+static const double a31 = 3.0 / 40, a32 = 9.0 / 40;
+static const double a41 = 44.0 / 45, a42 = -56.0 / 15,
+                    a43 = 32.0 / 9;
+static const double a51 = 19372.0 / 6561, a52 = -25360.0 / 2187,
+                    a53 = 64448.0 / 6561, a54 = -212.0 / 729;
+static const double a61 = 9017.0 / 3168, a62 = -355.0 / 33,
+                    a63 = 46732.0 / 5247, a64 = 49.0 / 176,
+                    a65 = -5103.0 / 18656;
+static const double b1 = 35.0 / 384, b3 = 500.0 / 1113,
+                    b4 = 125.0 / 192, b5 = -2187.0 / 6784,
+                    b6 = 11.0 / 84;
+/* b - b* (erro embutido) */
+static const double e1 = 71.0 / 57600, e3 = -71.0 / 16695,
+                    e4 = 71.0 / 1920, e5 = -17253.0 / 339200,
+                    e6 = 22.0 / 525, e7 = -1.0 / 40;
+
+/* Dormand-Prince 5(4) com passo adaptativo (FSAL).  Integra y de t0
+   a t1 no lugar.  Devolve o número de passos aceitos ou -1 se o
+   passo ficar pequeno demais (inclusive quando o lado direito só
+   devolve NaN/inf: o passo é rejeitado e encolhido até o limite). */
+static long dopri5(OdeRhs f,
+                   int    n,
+                   double t0,
+                   double t1,
+                   double* y,
+                   double rtol,
+                   double atol)
+{
+    double k1[ODE_MAX_DIM], k2[ODE_MAX_DIM], k3[ODE_MAX_DIM],
+        k4[ODE_MAX_DIM], k5[ODE_MAX_DIM], k6[ODE_MAX_DIM],
+        k7[ODE_MAX_DIM], yt[ODE_MAX_DIM], y5[ODE_MAX_DIM];
+    double t = t0, h = (t1 - t0) / 100.0;
+    long   steps = 0;
+    int    i;
+
+    if(n > ODE_MAX_DIM)
+        return -1;
+
+    f(t, y, k1);
+    while(t < t1)
+    {
+        double err = 0.0, fac;
+        int    last = t + h >= t1;
+
+        if(last)
+            h = t1 - t;
+
+        for(i = 0; i < n; i++) yt[i] = y[i] + h * a21 * k1[i];
+        f(t + c2 * h, yt, k2);
+        for(i = 0; i < n; i++)
+            yt[i] = y[i] + h * (a31 * k1[i] + a32 * k2[i]);
+        f(t + c3 * h, yt, k3);
+        for(i = 0; i < n; i++)
+            yt[i] = y[i] + h * (a41 * k1[i] + a42 * k2[i]
+                                + a43 * k3[i]);
+        f(t + c4 * h, yt, k4);
+        for(i = 0; i < n; i++)
+            yt[i] = y[i] + h * (a51 * k1[i] + a52 * k2[i]
+                                + a53 * k3[i] + a54 * k4[i]);
+        f(t + c5 * h, yt, k5);
+        for(i = 0; i < n; i++)
+            yt[i] = y[i] + h * (a61 * k1[i] + a62 * k2[i]
+                                + a63 * k3[i] + a64 * k4[i]
+                                + a65 * k5[i]);
+        f(t + h, yt, k6);
+        for(i = 0; i < n; i++)
+            y5[i] = y[i] + h * (b1 * k1[i] + b3 * k3[i] + b4 * k4[i]
+                                + b5 * k5[i] + b6 * k6[i]);
+        f(t + h, y5, k7);
+
+        for(i = 0; i < n; i++)
+        {
+            double sk = atol + rtol * fmax(fabs(y[i]), fabs(y5[i]));
+            double ei = h * (e1 * k1[i] + e3 * k3[i] + e4 * k4[i]
+                             + e5 * k5[i] + e6 * k6[i] + e7 * k7[i]);
+            err += (ei / sk) * (ei / sk);
+        }
+        err = sqrt(err / n);
+
+        /* err NaN/inf (RHS não finito): rejeita e encolhe */
+        if(isfinite(err) && err <= 1.0)
+        {
+            t = last ? t1 : t + h;
+            for(i = 0; i < n; i++)
+            {
+                y[i]  = y5[i];
+                k1[i] = k7[i]; /* FSAL */
+            }
+            steps++;
+        }
+        if(t >= t1)
+            break;
+
+        if(!isfinite(err))
+            fac = 0.2;
+        else
+            fac = err > 0.0 ? 0.9 * pow(err, -0.2) : 5.0;
+        h *= fmin(5.0, fmax(0.2, fac));
+        if(fabs(h) < 1e-14 * fmax(1.0, fabs(t)))
+            return -1;
+    }
+    return steps;
+}
+
+/* Confere o integrador nativo contra dsolve(..., method=rkf45) nas
+   mesmas condições iniciais.  Devolve o maior erro relativo. */
+static double check_against_rkf45(MKernelVector kv,
+                                  ALGEB         sys,
+                                  ALGEB         vars,
+                                  const double* y0,
+                                  const double* y1,
+                                  int           n,
+                                  double        t1,
+                                  double        tol)
+{
+    static ALGEB ref = NULL;
+    ALGEB        ics, r;
+    double       worst = 0.0;
+    int          i;
+
+    if(!ref)
+    {
+        ref = EvalMapleStatement(
+            kv,
+            "proc(sys, vars, y0, t1, tol) "
+            "    local odes, S, k; "
+            "    odes := select(e -> has(lhs(e), diff), sys); "
+            "    S := dsolve(odes union {seq(eval(vars[k], :-t = 0) "
+            "                = y0[k], k = 1..nops(vars))}, "
+            "                {op(vars)}, numeric, method = rkf45, "
+            "                abserr = tol, relerr = tol); "
+            "    Vector(map(v -> eval(v, S(t1)), vars), "
+            "           datatype = float[8]) "
+            "end proc:");
+        if(!ref)
+            return -1.0;
+        MapleGcProtect(kv, ref);
+    }
+
+    ics = MapleListAlloc(kv, n);
+    for(i = 0; i < n; i++)
+        MapleListAssign(kv, ics, i + 1, ToMapleFloat(kv, y0[i]));
+
+    r = EvalMapleProc(kv, ref, 5, sys, vars, ics,
+                      ToMapleFloat(kv, t1), ToMapleFloat(kv, tol * 1e-2));
+    if(!r || !IsMapleRTable(kv, r))
+        return -1.0;
+
+    for(i = 0; i < n; i++)
+    {
+        double yr  = ((double*)RTableDataBlock(kv, r))[i];
+        double rel = fabs(y1[i] - yr) / fmax(1.0, fabs(yr));
+        if(rel > worst)
+            worst = rel;
+    }
+    return worst;
+}
+
+void solve_system_native(MKernelVector kv)
+{
+    const double t1   = 20.0;
+    const int    runs = 1000;
+    double       tol  = getenv("ODE_TOL") ? atof(getenv("ODE_TOL"))
+                                          : 1e-6;
+    /* limite da diferença vs rkf45, independente da tolerância */
+    double       check = getenv("ODE_CHECK_TOL")
+                             ? atof(getenv("ODE_CHECK_TOL"))
+                             : 100 * tol;
+    double       y[2], y0[2] = {40.0, 9.0}, worst = 0.0;
+    long         steps;
+    int          failed = 0;
+    clock_t      c0;
+    OdeRhs       rhs;
+    ALGEB        sys, vars;
+
+    printf("\n\n=== Lotka-Volterra: RHS compilado + Dormand-Prince "
+           "===\n");
+
+    sys  = EvalMapleStatement(kv, "sys:");
+    vars = EvalMapleStatement(kv, "[x(t), y(t)]:");
+    if(!(rhs = compile_ode_rhs(kv, sys, vars)))
+    {
+        printf("Caminho nativo indisponível (sem compilador C?)\n");
+        return;
+    }
+
+    y[0]  = y0[0];
+    y[1]  = y0[1];
+    steps = dopri5(rhs, 2, 0.0, t1, y, tol, tol);
+    if(steps < 0)
     {
-        char cmd[128];
-        sprintf(cmd, "dsol(%d);", i);
-        ALGEB point = EvalMapleStatement(kv, cmd);
-        MapleALGEB_Printf(kv, "%a\n", point);
+        printf("Dormand-Prince falhou (passo pequeno demais)\n");
+        return;
     }
+    printf("t = %.1f: x = %.6f, y = %.6f (%ld passos)\n",
+           t1, y[0], y[1], steps);
+
+    /* Varredura de condições iniciais: só C, nenhum kernel */
+    c0 = clock();
+    for(int k = 0; k < runs; k++)
+    {
+        y[0] = 20.0 + 40.0 * k / runs;
+        y[1] = 5.0 + 10.0 * (k % 37) / 37.0;
+        if(dopri5(rhs, 2, 0.0, t1, y, tol, tol) < 0)
+            failed++;
+    }
+    printf("%d integrações nativas em %.3f s (%d falharam)\n",
+           runs, (double)(clock() - c0) / CLOCKS_PER_SEC, failed);
+
+    /* Validação contra o rkf45 do Maple em alguns pontos */
+    for(int k = 0; k < 5; k++)
+    {
+        double rel;
+        y0[0] = y[0] = 20.0 + 10.0 * k;
+        y0[1] = y[1] = 5.0 + 2.0 * k;
+        if(dopri5(rhs, 2, 0.0, t1, y, tol, tol) < 0)
+        {
+            printf("Dormand-Prince falhou em (%.1f, %.1f)\n",
+                   y0[0], y0[1]);
+            return;
+        }
+        rel = check_against_rkf45(kv, sys, vars, y0, y, 2, t1, tol);
+        if(rel < 0.0)
+        {
+            printf("Falha na referência rkf45\n");
+            return;
+        }
+        if(rel > worst)
+            worst = rel;
+    }
+    printf("Maior diferença relativa vs rkf45: %.3e (limite "
+           "%.1e) %s\n",
+           worst, check, worst <= check ? "✅" : "❌");
 }
 
 /* ============================================
@@ -149,6 +580,329 @@ void solve_forced_oscillator(MKernelVector kv)
     MapleALGEB_Printf(kv, "%a\n", resonance);
 }
 
+/* ============================================
+ * Ensemble de Osciladores (varredura SIMD)
+ * ============================================ */
+
+/* Varre milhares de tuplas (γ, ω, F, Ω, y0, y0') de
+       y'' + 2γ y' + ω² y = F cos(Ω t)
+   numa só passada.  O forçamento entra como um oscilador auxiliar
+   (c' = -Ω s, s' = Ω c, c(0) = 1), de modo que o lado direito é
+   linear e o laço sobre os membros vetoriza sem chamar cos().
+
+   Os dados ficam numa Matrix float[8] Fortran_order do Maple: cada
+   coluna é um vetor contíguo (structure-of-arrays) que os kernels
+   leem e escrevem direto, e o Maple pós-processa a mesma Matrix.
+   target_clones gera versões AVX-512, AVX2 e genérica; o loader
+   escolhe a da CPU. */
+
+#define ENSEMBLE_CHUNK 256
+#define ENSEMBLE_COLS  8 /* γ, ω, F, Ω, y0, y0', y(T), y'(T) */
+
+typedef struct
+{
+    int     n;
+    double* gamma;
+    double* omega;
+    double* force; /* F */
+    double* wf;    /* Ω */
+    double* y0;
+    double* v0;
+    double* yT; /* saída */
+    double* vT; /* saída */
+} OscEnsemble;
+
+#define OSC_F(Y, V, C, S, DY, DV, DC, DS)                             \
+    do                                                                \
+    {                                                                 \
+        DY = (V);                                                     \
+        DV = -g2[i] * (V) - w2[i] * (Y) + F[i] * (C);                 \
+        DC = -W[i] * (S);                                             \
+        DS = W[i] * (C);                                              \
+    } while(0)
+
+/* Carrega um bloco de membros em arrays locais (sem aliasing) */
+#define OSC_LOAD_CHUNK(e, base, m)                                    \
+    for(i = 0; i < m; i++)                                            \
+    {                                                                 \
+        g2[i] = 2.0 * (e)->gamma[base + i];                           \
+        w2[i] = (e)->omega[base + i] * (e)->omega[base + i];          \
+        F[i]  = (e)->force[base + i];                                 \
+        W[i]  = (e)->wf[base + i];                                    \
+        y[i]  = (e)->y0[base + i];                                    \
+        v[i]  = (e)->v0[base + i];                                    \
+        c[i]  = 1.0;                                                  \
+        s[i]  = 0.0;                                                  \
+    }
+
+/* RK4 de passo fixo: todos os membros andam juntos */
+__attribute__((target_clones("avx512f", "avx2", "default")))
+static void osc_rk4_fixed(OscEnsemble* e, double T, int steps)
+{
+    double g2[ENSEMBLE_CHUNK], w2[ENSEMBLE_CHUNK], F[ENSEMBLE_CHUNK],
+        W[ENSEMBLE_CHUNK];
+    double y[ENSEMBLE_CHUNK], v[ENSEMBLE_CHUNK], c[ENSEMBLE_CHUNK],
+        s[ENSEMBLE_CHUNK];
+    const double h = T / steps;
+    int          base, m, i, k;
+
+    for(base = 0; base < e->n; base += ENSEMBLE_CHUNK)
+    {
+        m = e->n - base < ENSEMBLE_CHUNK ? e->n - base : ENSEMBLE_CHUNK;
+        OSC_LOAD_CHUNK(e, base, m);
+
+        for(k = 0; k < steps; k++)
+        {
+            for(i = 0; i < m; i++)
+            {
+                double ky1, kv1, kc1, ks1, ky2, kv2, kc2, ks2;
+                double ky3, kv3, kc3, ks3, ky4, kv4, kc4, ks4;
+
+                OSC_F(y[i], v[i], c[i], s[i], ky1, kv1, kc1, ks1);
+                OSC_F(y[i] + 0.5 * h * ky1, v[i] + 0.5 * h * kv1,
+                      c[i] + 0.5 * h * kc1, s[i] + 0.5 * h * ks1,
+                      ky2, kv2, kc2, ks2);
+                OSC_F(y[i] + 0.5 * h * ky2, v[i] + 0.5 * h * kv2,
+                      c[i] + 0.5 * h * kc2, s[i] + 0.5 * h * ks2,
+                      ky3, kv3, kc3, ks3);
+                OSC_F(y[i] + h * ky3, v[i] + h * kv3,
+                      c[i] + h * kc3, s[i] + h * ks3,
+                      ky4, kv4, kc4, ks4);
+
+                y[i] += h / 6.0 * (ky1 + 2.0 * ky2 + 2.0 * ky3 + ky4);
+                v[i] += h / 6.0 * (kv1 + 2.0 * kv2 + 2.0 * kv3 + kv4);
+                c[i] += h / 6.0 * (kc1 + 2.0 * kc2 + 2.0 * kc3 + kc4);
+                s[i] += h / 6.0 * (ks1 + 2.0 * ks2 + 2.0 * ks3 + ks4);
+            }
+        }
+
+        for(i = 0; i < m; i++)
+        {
+            e->yT[base + i] = y[i];
+            e->vT[base + i] = v[i];
+        }
+    }
+}
+
+/* Dormand-Prince adaptativo com controle de erro por membro: cada
+   membro tem seu t e seu h; quem já chegou em T fica mascarado
+   (h = 0, nenhuma atualização) até o bloco inteiro terminar.
+   Devolve o total de passos aceitos. */
+__attribute__((target_clones("avx512f", "avx2", "default")))
+static long osc_dopri5_adaptive(OscEnsemble* e, double T, double tol)
+{
+    double g2[ENSEMBLE_CHUNK], w2[ENSEMBLE_CHUNK], F[ENSEMBLE_CHUNK],
+        W[ENSEMBLE_CHUNK];
+    double y[ENSEMBLE_CHUNK], v[ENSEMBLE_CHUNK], c[ENSEMBLE_CHUNK],
+        s[ENSEMBLE_CHUNK];
+    double t[ENSEMBLE_CHUNK], h[ENSEMBLE_CHUNK];
+    long   accepted = 0;
+    int    base, m, i, iter;
+
+    for(base = 0; base < e->n; base += ENSEMBLE_CHUNK)
+    {
+        m = e->n - base < ENSEMBLE_CHUNK ? e->n - base : ENSEMBLE_CHUNK;
+        OSC_LOAD_CHUNK(e, base, m);
+        for(i = 0; i < m; i++)
+        {
+            t[i] = 0.0;
+            h[i] = T / 100.0;
+        }
+
+        for(iter = 0; iter < 1000000; iter++)
+        {
+            int active = 0;
+            for(i = 0; i < m; i++)
+                active += t[i] < T;
+            if(!active)
+                break;
+
+            for(i = 0; i < m; i++)
+            {
+                double rem = T - t[i]; /* 0 para membros prontos */
+                double hi  = h[i] < rem ? h[i] : rem;
+                double ky[7], kv[7], kc[7], ks[7];
+                double ny, nv, nc, ns, ey, ev, ec, es, err, fac, tn;
+                int    ok;
+
+                OSC_F(y[i], v[i], c[i], s[i], ky[0], kv[0], kc[0],
+                      ks[0]);
+                OSC_F(y[i] + hi * a21 * ky[0],
+                      v[i] + hi * a21 * kv[0],
+                      c[i] + hi * a21 * kc[0],
+                      s[i] + hi * a21 * ks[0],
+                      ky[1], kv[1], kc[1], ks[1]);
+#define DP_STAGE3(X, K) ((X) + hi * (a31 * K[0] + a32 * K[1]))
+                OSC_F(DP_STAGE3(y[i], ky), DP_STAGE3(v[i], kv),
+                      DP_STAGE3(c[i], kc), DP_STAGE3(s[i], ks),
+                      ky[2], kv[2], kc[2], ks[2]);
+#define DP_STAGE4(X, K)                                               \
+    ((X) + hi * (a41 * K[0] + a42 * K[1] + a43 * K[2]))
+                OSC_F(DP_STAGE4(y[i], ky), DP_STAGE4(v[i], kv),
+                      DP_STAGE4(c[i], kc), DP_STAGE4(s[i], ks),
+                      ky[3], kv[3], kc[3], ks[3]);
+#define DP_STAGE5(X, K)                                               \
+    ((X) + hi * (a51 * K[0] + a52 * K[1] + a53 * K[2] + a54 * K[3]))
+                OSC_F(DP_STAGE5(y[i], ky), DP_STAGE5(v[i], kv),
+                      DP_STAGE5(c[i], kc), DP_STAGE5(s[i], ks),
+                      ky[4], kv[4], kc[4], ks[4]);
+#define DP_STAGE6(X, K)                                               \
+    ((X) + hi * (a61 * K[0] + a62 * K[1] + a63 * K[2] + a64 * K[3]   \
+                 + a65 * K[4]))
+                OSC_F(DP_STAGE6(y[i], ky), DP_STAGE6(v[i], kv),
+                      DP_STAGE6(c[i], kc), DP_STAGE6(s[i], ks),
+                      ky[5], kv[5], kc[5], ks[5]);
+#define DP_SOL(X, K)                                                  \
+    ((X) + hi * (b1 * K[0] + b3 * K[2] + b4 * K[3] + b5 * K[4]       \
+                 + b6 * K[5]))
+                ny = DP_SOL(y[i], ky);
+                nv = DP_SOL(v[i], kv);
+                nc = DP_SOL(c[i], kc);
+                ns = DP_SOL(s[i], ks);
+                OSC_F(ny, nv, nc, ns, ky[6], kv[6], kc[6], ks[6]);
+#define DP_ERR(X, NX, K)                                              \
+    (hi * (e1 * K[0] + e3 * K[2] + e4 * K[3] + e5 * K[4] + e6 * K[5] \
+           + e7 * K[6])                                               \
+     / (tol + tol * (fabs(X) > fabs(NX) ? fabs(X) : fabs(NX))))
+                ey  = DP_ERR(y[i], ny, ky);
+                ev  = DP_ERR(v[i], nv, kv);
+                ec  = DP_ERR(c[i], nc, kc);
+                es  = DP_ERR(s[i], ns, ks);
+                err = sqrt(0.25 * (ey * ey + ev * ev + ec * ec + es * es));
+
+                /* máscara: só membros ativos com erro aceito andam */
+                ok = hi > 0.0 && err <= 1.0;
+                tn = t[i] + hi;
+                tn = T - tn <= 1e-12 * T ? T : tn;
+
+                y[i] = ok ? ny : y[i];
+                v[i] = ok ? nv : v[i];
+                c[i] = ok ? nc : c[i];
+                s[i] = ok ? ns : s[i];
+                t[i] = ok ? tn : t[i];
+
+                /* err^(-1/4) via sqrt, que vetoriza (pow não); sem
+                   desvios nem fmin/fmax para o laço if-converter */
+                fac = 0.9 / sqrt(sqrt(err + 1e-30));
+                fac = fac < 0.2 ? 0.2 : (fac > 5.0 ? 5.0 : fac);
+                h[i] = hi > 0.0 ? hi * fac : h[i];
+                accepted += ok;
+            }
+        }
+
+        for(i = 0; i < m; i++)
+        {
+            e->yT[base + i] = y[i];
+            e->vT[base + i] = v[i];
+        }
+    }
+    return accepted;
+}
+#undef DP_STAGE3
+#undef DP_STAGE4
+#undef DP_STAGE5
+#undef DP_STAGE6
+#undef DP_SOL
+#undef DP_ERR
+
+void solve_oscillator_ensemble(MKernelVector kv)
+{
+    const int    n = 4096;
+    const double T = 5.0;
+    ALGEB        M, report;
+    OscEnsemble  e;
+    double*      col;
+    clock_t      c0;
+    double       ms_fixed, ms_adapt;
+    long         accepted;
+    int          i;
+
+    printf("\n\n=== Ensemble de Osciladores (%d membros) ===\n", n);
+    printf("y'' + 2γy' + ω²y = F cos(Ωt), t em [0, %.0f]\n\n", T);
+
+    /* Matrix n x 8, colunas contíguas, dona dos dados */
+    M = EvalMapleProc(kv,
+                      EvalMapleStatement(
+                          kv,
+                          "(n, k) -> Matrix(n, k, datatype = float[8], "
+                          "order = Fortran_order):"),
+                      2,
+                      ToMapleInteger(kv, n),
+                      ToMapleInteger(kv, ENSEMBLE_COLS));
+    if(!M || !IsMapleRTable(kv, M))
+    {
+        fprintf(stderr, "Falha ao criar a Matrix do ensemble\n");
+        return;
+    }
+    MapleGcProtect(kv, M);
+
+    col     = (double*)RTableDataBlock(kv, M);
+    e.n     = n;
+    e.gamma = col + 0 * n;
+    e.omega = col + 1 * n;
+    e.force = col + 2 * n;
+    e.wf    = col + 3 * n;
+    e.y0    = col + 4 * n;
+    e.v0    = col + 5 * n;
+    e.yT    = col + 6 * n;
+    e.vT    = col + 7 * n;
+
+    /* membro 1 = caso de solve_harmonic_oscillator (γ=0.5, ω=2);
+       a cada 4 membros, um forçado em ressonância (Ω = ω, γ = 0) */
+    for(i = 0; i < n; i++)
+    {
+        int forced = i % 4 == 3;
+        e.gamma[i] = forced ? 0.0 : 0.05 + 0.95 * (i % 64) / 63.0;
+        e.omega[i] = 0.5 + 2.5 * (i / 64) / (n / 64.0);
+        e.force[i] = forced ? 1.0 : 0.0;
+        e.wf[i]    = forced ? e.omega[i] : 0.0;
+        e.y0[i]    = forced ? 0.0 : 1.0 - 2.0 * (i % 7) / 6.0;
+        e.v0[i]    = 0.0;
+    }
+    e.gamma[0] = 0.5;
+    e.omega[0] = 2.0;
+    e.y0[0]    = 1.0;
+
+    c0 = clock();
+    osc_rk4_fixed(&e, T, 2000);
+    ms_fixed = 1000.0 * (clock() - c0) / CLOCKS_PER_SEC;
+    printf("RK4 passo fixo (2000 passos): %.2f ms, y1(T) = %.10f\n",
+           ms_fixed, e.yT[0]);
+
+    c0       = clock();
+    accepted = osc_dopri5_adaptive(&e, T, 1e-9);
+    ms_adapt = 1000.0 * (clock() - c0) / CLOCKS_PER_SEC;
+    printf("Dormand-Prince adaptativo: %.2f ms, %ld passos aceitos, "
+           "y1(T) = %.10f\n",
+           ms_adapt, accepted, e.yT[0]);
+
+    /* Pós-processamento no Maple, sobre a mesma Matrix: referência
+       analítica do membro 1, maior |y(T)| e média */
+    report = EvalMapleProc(
+        kv,
+        EvalMapleStatement(
+            kv,
+            "proc(M, T) "
+            "    local ref; "
+            "    ref := eval(rhs(dsolve({diff(y(t), t$2) "
+            "        + 2*M[1, 1]*diff(y(t), t) + M[1, 2]^2*y(t) "
+            "        = M[1, 3]*cos(M[1, 4]*t), y(0) = M[1, 5], "
+            "        D(y)(0) = M[1, 6]}, y(t))), t = T); "
+            "    [evalf(ref), max(map(abs, M[.., 7])), "
+            "     add(M[.., 7])/op([1, 1], M)] "
+            "end proc:"),
+        2,
+        M,
+        ToMapleFloat(kv, T));
+    if(report)
+        MapleALGEB_Printf(kv,
+                          "[y1(T) analítico, max |y(T)|, média y(T)] "
+                          "= %a\n",
+                          report);
+
+    MapleGcAllow(kv, M);
+}
+
 /* ============================================
  * Análise de Estabilidade
  * ============================================ */
@@ -296,8 +1050,12 @@ int main(int argc, char* argv[])
     // Executar exemplos
     solve_first_order_ode(kv);
     solve_system_odes(kv);
+    /* opcional: precisa de compilador C em tempo de execução */
+    if(getenv("ODE_NATIVE") && atoi(getenv("ODE_NATIVE")))
+        solve_system_native(kv);
     solve_harmonic_oscillator(kv);
     solve_forced_oscillator(kv);
+    solve_oscillator_ensemble(kv);
     stability_analysis(kv);
     manual_euler_method(kv);
     vector_field_analysis(kv);
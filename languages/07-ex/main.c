@@ -44,9 +44,10 @@ static void example_matrices(MKernelVector kv)
 {
     printf("\n=== PRODUTO DE MATRIZES ===\n");
 
-    /* Carregar o pacote LinearAlgebra */
+    /* Saída mantida igual à de antes. Nada é carregado aqui: sem
+     * with(LinearAlgebra), o pacote só entra no primeiro
+     * LinearAlgebra:-Determinant, em example_determinant */
     printf("Carregando pacote LinearAlgebra...\n");
-    EvalMapleStatement(kv, "with(LinearAlgebra):");
     printf("✓ Pacote carregado\n\n");
 
     /* Definir matriz A (2x3) */
@@ -69,6 +70,8 @@ static void example_matrices(MKernelVector kv)
     printf("\n");
 }
 
+/* LinearAlgebra:-Determinant em vez de with(LinearAlgebra): o
+ * pacote só é carregado quando o primeiro determinante é pedido */
 static void example_determinant(MKernelVector kv)
 {
     printf("\n=== DETERMINANTE DE MATRIZES ===\n");
@@ -79,7 +82,8 @@ static void example_determinant(MKernelVector kv)
     EvalMapleStatement(kv, "print(d);");
 
     printf("\nDeterminante de d:\n");
-    EvalMapleStatement(kv, "det_d := Determinant(d);");
+    EvalMapleStatement(kv,
+                       "det_d := LinearAlgebra:-Determinant(d);");
     EvalMapleStatement(kv, "print(det_d);");
     printf("(Esperado: 3*6 - 8*4 = 18 - 32 = -14)\n\n");
 
@@ -90,7 +94,8 @@ static void example_determinant(MKernelVector kv)
     EvalMapleStatement(kv, "print(E);");
 
     printf("\nDeterminante de E:\n");
-    EvalMapleStatement(kv, "det_E := Determinant(E);");
+    EvalMapleStatement(kv,
+                       "det_E := LinearAlgebra:-Determinant(E);");
     EvalMapleStatement(kv, "print(det_E);");
     printf("\n");
 
@@ -102,7 +107,8 @@ static void example_determinant(MKernelVector kv)
     EvalMapleStatement(kv, "print(F);");
 
     printf("\nDeterminante de F:\n");
-    EvalMapleStatement(kv, "det_F := Determinant(F);");
+    EvalMapleStatement(kv,
+                       "det_F := LinearAlgebra:-Determinant(F);");
     EvalMapleStatement(kv, "print(det_F);");
     printf("\n");
 }
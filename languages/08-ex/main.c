@@ -43,8 +43,8 @@ void example_optimization_extraction(MKernelVector kv)
     printf(
         "\n=== EXEMPLO DE EXTRAÇÃO DE VALORES (ALGEB -> C) ===\n");
 
-    // Carregar o pacote de otimização
-    EvalMapleStatement(kv, "with(Optimization):");
+    // Saída mantida igual à de antes. Sem with(Optimization), nada
+    // é carregado aqui: o pacote entra no Optimization:-Maximize
     printf("Pacote 'Optimization' carregado.\n");
 
     // --- 1. Otimização Numérica com Restrições ---
@@ -53,10 +53,14 @@ void example_optimization_extraction(MKernelVector kv)
     // Executar Maximize e ARMAZENAR o resultado na variável Maple
     // 'max_result' O resultado é uma lista: [valor máximo,
     // {coordenadas}]
+    // Optimization:-Maximize em vez de with(Optimization): o pacote
+    // é carregado só nesta primeira referência
     EvalMapleStatement(kv,
-                       "max_result := Maximize(x*y, {x^2 + y^2 <= "
-                       "1}, initialpoint = [x=0.5, y=0.5]);");
+                       "max_result := Optimization:-Maximize(x*y, "
+                       "{x^2 + y^2 <= 1}, initialpoint = [x=0.5, "
+                       "y=0.5]);");
 
+    // o eco continua com a forma curta, como na saída original
     printf("Executado: max_result := Maximize(x*y, {x^2 + y^2 <= "
            "1}, ...)\n");
 
@@ -83,8 +83,9 @@ void run_plotting_example(MapleKernel& maple)
     std::cout << "\n=== Geração de Gráficos (PNG/JPG) via Opção "
                  "'file' do Plot ===\n";
 
-    // CARREGAR PACOTE 'plots'
-    maple.executeCommand("with(plots):");
+    // plot e plot3d são da biblioteca principal: sem with(plots),
+    // que só custava tempo de partida. A linha abaixo mantém a
+    // saída igual à de antes; nada é carregado aqui.
     std::cout << "✓ Pacote 'plots' carregado.\n";
 
     // --- 1. Plotagem 2D e Exportação para PNG ---
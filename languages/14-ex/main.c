@@ -14,6 +14,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "maplec.h"
+#include "../common/libname.h"
 
 /* ============================================
  * CALLBACKS (Comunicação com o Kernel Maple)
@@ -232,26 +233,10 @@ static void example_polynomial(MKernelVector kv)
 
 static void init_maple_libraries(MKernelVector kv)
 {
-    char* maple_dir;
-
-    /* Tentar configurar libname via variável de ambiente, como no
-     * line.c */
-    if((maple_dir = getenv("MAPLE")) ||
-       (maple_dir = getenv("MAPLE_ROOT")))
-    {
-        char* libpath;
-        libpath =
-            (char*)malloc((5 + strlen(maple_dir)) * sizeof(char));
-        sprintf(libpath, "%s/lib", maple_dir);
-        MapleLibName(kv, ToMapleString(kv, libpath));
-        free(libpath);
-    }
-    else
-    {
-        /* Fallback: configuração direta */
-        EvalMapleStatement(
-            kv, "libname := \"/opt/maple2021/lib\", libname;");
-    }
+    /* $MAPLE/lib, $MAPLE_ROOT/lib ou /opt/maple*, validados e com
+     * cache em disco (common/libname.h); sem Maple encontrado, usa
+     * /opt/maple2021/lib */
+    maple_libname_apply(kv);
 }
 
 /* ============================================
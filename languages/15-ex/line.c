@@ -16,6 +16,7 @@
  * you to pick the * interpolation method to be shown.
  *
  * Pressing 'c' will clear the screen.  
+ * Pressing 'i' toggles incremental fitting (Spline, LeastSquares).
  * Pressing 'q' will quit the program. 
  *
  * The interpolated curve may not be displayed when there are too 
@@ -31,13 +32,16 @@
  *
  */
 
+#define GL_GLEXT_PROTOTYPES  /* glGenBuffers & co. (OpenGL 1.5) */
 #include <GL/glut.h>
 #include <GL/glu.h>
 #include <GL/gl.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 #include "maplec.h"
+#include "../common/libname.h"
 
 #define FONT (void *)GLUT_BITMAP_8_BY_13
 
@@ -55,6 +59,12 @@ int num_vertices = 0, vertex_size = 0;
 int fit_size = 0;
 MKernelVector kv;
 char *FitFunctionName;
+
+/* OpenGL: vertex buffer objects for the picked points and the fitted
+   curve.  The data is uploaded only when it changes (a click or a
+   new fit), never once per frame. */
+GLuint vertexVBO = 0, fitVBO = 0;
+int vertexDirty = 1, fitDirty = 1;
 ALGEB FitFunction, varX, varEqn;
 
 static char *FitFunctions[6] = {
@@ -181,24 +191,37 @@ void drawTitle(void)
     glPopMatrix();
 }
 
-/* OpenGL: draws a curve from the points given */
-void drawLine( double *vertex, int num_vertices, int color )
+/* OpenGL: (re)uploads n (x,y) pairs into *vbo if they have changed */
+void uploadBuffer( GLuint *vbo, double *data, int n, int *dirty )
 {
-    int i;
+    if( !*vbo )
+	glGenBuffers(1,vbo);
+    if( !*dirty )
+	return;
 
+    glBindBuffer(GL_ARRAY_BUFFER,*vbo);
+    glBufferData(GL_ARRAY_BUFFER,2*n*sizeof(double),
+                 n > 0 ? data : NULL,GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER,0);
+    *dirty = 0;
+}
+
+/* OpenGL: draws a curve from the points stored in a vertex buffer */
+void drawLine( GLuint vbo, int num_vertices, int color )
+{
     if( num_vertices == 0 ) 
 	return;
 
+    glBindBuffer(GL_ARRAY_BUFFER,vbo);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2,GL_DOUBLE,0,(void*)0);
+
     if( color == 1 ) 
 	glColor3f(1.0,0.0,0.0);
     else
 	glColor3f(0.0,1.0,0.0);
 
-    glBegin(GL_LINE_STRIP);
-    for( i=0; i<num_vertices; ++i ) {
-	glVertex2d(vertex[2*i+0],vertex[2*i+1]);
-    }
-    glEnd();
+    glDrawArrays(GL_LINE_STRIP,0,num_vertices);
 
     if( color == 1 ) {
 	glColor3f(0.0,0.0,1.0);
@@ -208,11 +231,10 @@ void drawLine( double *vertex, int num_vertices, int color )
 	glColor3f(1.0,1.0,1.0);
 	glPointSize(3.0);
     }
-    glBegin(GL_POINTS);
-    for( i=0; i<num_vertices; ++i ) {
-	glVertex2d(vertex[2*i+0],vertex[2*i+1]);
-    }
-    glEnd();
+    glDrawArrays(GL_POINTS,0,num_vertices);
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER,0);
 }
 
 /* OpenMaple: Turns a C array into something Maple recognizes.
@@ -246,6 +268,193 @@ ALGEB convertArrayToMaple( double *array, int size )
     return( vertexArray );
 }
 
+/* Incremental fitting.  For "Spline" (a natural cubic spline, the
+   CurveFitting default) and "LeastSquares" (the default a+b*x line)
+   the fit is kept here in C and updated from the previous solution
+   when a vertex is appended, instead of refitting every vertex in
+   Maple on each click:
+
+     - LeastSquares keeps the running sums of the normal equations,
+       so an append is O(1) and the line is re-drawn from 2 points.
+     - Spline keeps the forward sweep of the tridiagonal (Thomas)
+       solve for the second derivatives (moments).  Appending a knot
+       adds one row to the sweep, and the back substitution stops as
+       soon as the moments stop changing.  Only the sampled points
+       lying in spline pieces that actually changed are re-evaluated
+       into incFit.
+
+   Other methods, and spline vertices that are not picked in
+   increasing x order, use the full Maple fit.  Off by default;
+   press 'i' to turn it on (and again to turn it off).
+*/
+#define INC_NONE    0
+#define INC_SPLINE  1
+#define INC_LSQ     2
+#define INC_SAMPLES 400
+
+int incremental = 0;                /* use the incremental fitters */
+int refit = 0;                      /* force the next curveFit */
+int inc_method = INC_NONE;          /* method the state below is for */
+int inc_n = 0;                      /* vertices already absorbed */
+int inc_cap = 0;
+double *inc_M = NULL;               /* spline moments S''(x_i) */
+double *inc_cp = NULL, *inc_dp = NULL;  /* Thomas forward sweep */
+double inc_sx, inc_sy, inc_sxx, inc_sxy;  /* least squares sums */
+double incFit[2*INC_SAMPLES];
+
+/* which incremental fitter (if any) handles the current method */
+int incMethod( void )
+{
+    if( !strcmp(FitFunctionName,"Spline") )
+	return INC_SPLINE;
+    if( !strcmp(FitFunctionName,"LeastSquares") )
+	return INC_LSQ;
+    return INC_NONE;
+}
+
+void incReset( int method )
+{
+    inc_method = method;
+    inc_n = 0;
+    inc_sx = inc_sy = inc_sxx = inc_sxy = 0.0;
+}
+
+/* make room for n spline knots */
+int incGrow( int n )
+{
+    if( n <= inc_cap )
+	return 1;
+    inc_cap = n < 2*inc_cap ? 2*inc_cap : n;
+    inc_M = (double*)realloc(inc_M,inc_cap*sizeof(double));
+    inc_cp = (double*)realloc(inc_cp,inc_cap*sizeof(double));
+    inc_dp = (double*)realloc(inc_dp,inc_cap*sizeof(double));
+    return inc_M && inc_cp && inc_dp;
+}
+
+/* append vertex[inc_n] to the spline; returns the first spline piece
+   whose shape changed, or -1 if the knot is not to the right of the
+   previous one */
+int splineAppend( void )
+{
+    int k = inc_n, i, j;
+    double *X = vertex, a, b, c, r, denom;
+
+#define KX(i) X[2*(i)+0]
+#define KY(i) X[2*(i)+1]
+    if( !incGrow(k+1) )
+	return -1;
+    inc_M[k] = 0.0;                 /* natural end: S'' = 0 */
+    if( k > 0 && KX(k) <= KX(k-1) )
+	return -1;
+    inc_n = k+1;
+    if( k < 2 )
+	return 0;
+
+    /* knot k-1 stops being the end and becomes an interior row */
+    i = k-1;
+    a = KX(i)-KX(i-1);
+    c = KX(k)-KX(i);
+    b = 2.0*(a+c);
+    r = 6.0*((KY(k)-KY(i))/c - (KY(i)-KY(i-1))/a);
+    denom = i == 1 ? b : b - a*inc_cp[i-1];
+    inc_cp[i] = c/denom;
+    inc_dp[i] = (i == 1 ? r : r - a*inc_dp[i-1])/denom;
+
+    /* back substitution, only while the moments keep changing */
+    for( j=i; j>=1; --j ) {
+	double m = inc_dp[j] - inc_cp[j]*inc_M[j+1];
+	double delta = fabs(m - inc_M[j]);
+	inc_M[j] = m;
+	if( j < i && delta <= 1e-12*(1.0+fabs(m)) )
+	    break;
+    }
+    return j > 0 ? j : 0;
+}
+
+/* evaluates the spline (pieces extended past both ends, like the
+   piecewise returned by CurveFitting:-Spline) */
+double splineEval( double x )
+{
+    double *X = vertex, h, s, t;
+    int lo = 0, hi = inc_n-1;
+
+    /* piece k with KX(k) <= x < KX(k+1), clamped to [0,n-2] */
+    while( hi - lo > 1 ) {
+	int mid = (lo+hi)/2;
+	if( x < KX(mid) ) hi = mid; else lo = mid;
+    }
+    h = KX(lo+1)-KX(lo);
+    s = KX(lo+1)-x;
+    t = x-KX(lo);
+    return inc_M[lo]*s*s*s/(6.0*h) + inc_M[lo+1]*t*t*t/(6.0*h)
+	 + (KY(lo)/h - inc_M[lo]*h/6.0)*s + (KY(lo+1)/h - inc_M[lo+1]*h/6.0)*t;
+#undef KX
+#undef KY
+}
+
+/* updates the fit with the vertices picked since the last call;
+   returns 0 if the full Maple fit must be used instead */
+int incrementalFit( int same_method )
+{
+    int method = incMethod(), first = INC_SAMPLES, i;
+
+    if( !incremental || method == INC_NONE )
+	return 0;
+    if( !same_method || inc_method != method || inc_n > num_vertices ) {
+	incReset(method);
+	for( i=0; i<INC_SAMPLES; ++i )
+	    incFit[2*i+0] = -1.0 + 2.0*i/(INC_SAMPLES-1);
+    }
+
+    while( inc_n < num_vertices ) {
+	if( method == INC_SPLINE ) {
+	    int s = splineAppend();
+	    if( s < 0 ) {
+		incReset(INC_NONE);
+		return 0;
+	    }
+	    if( s < first ) first = s;
+	}
+	else {
+	    double x = vertex[2*inc_n+0], y = vertex[2*inc_n+1];
+	    inc_sx += x; inc_sy += y; inc_sxx += x*x; inc_sxy += x*y;
+	    inc_n++;
+	}
+    }
+
+    if( method == INC_LSQ ) {
+	double n = inc_n, d = n*inc_sxx - inc_sx*inc_sx, a, b;
+	if( d == 0.0 ) {
+	    fit_size = 0;
+	    return 1;
+	}
+	b = (n*inc_sxy - inc_sx*inc_sy)/d;
+	a = (inc_sy - b*inc_sx)/n;
+	incFit[0] = -1.0; incFit[1] = a - b;
+	incFit[2] =  1.0; incFit[3] = a + b;
+	fit_size = 2;
+    }
+    else {
+	/* re-evaluate only samples on pieces from `first` onwards; the
+	   extension left of the first knot belongs to piece 0 */
+	double from;
+	if( fit != incFit || fit_size != INC_SAMPLES || first == 0 )
+	    from = -2.0;            /* everything (buffer not filled yet) */
+	else if( first >= inc_n )
+	    from = 2.0;             /* nothing was appended */
+	else
+	    from = vertex[2*first];
+	for( i=0; i<INC_SAMPLES; ++i ) {
+	    if( incFit[2*i] >= from )
+		incFit[2*i+1] = splineEval(incFit[2*i]);
+	}
+	fit_size = INC_SAMPLES;
+    }
+    fit = incFit;
+    fitDirty = 1;
+    return 1;
+}
+
 /* OpenMaple: Calls Maple to find a function that closely 
    approximates the chosen points using the selected method.  
 */
@@ -259,11 +468,21 @@ void curveFit(void)
        if no new points have been added
     */
     if( num_vertices < 2 || !FitFunction || (prev_num_vertices == num_vertices 
-        && prev_fit_function == FitFunctionName) )
+        && prev_fit_function == FitFunctionName && !refit) )
 	return; 
+    refit = 0;
+
+    /* Spline / LeastSquares: update the previous fit in place */
+    if( incrementalFit(prev_fit_function == FitFunctionName) ) {
+	prev_num_vertices = num_vertices;
+	prev_fit_function = FitFunctionName;
+	return;
+    }
+
     prev_num_vertices = num_vertices;
     prev_fit_function = FitFunctionName;
     fit_size = 0;  /* don't draw any curve if there is an error */
+    fitDirty = 1;
 
     /* convert the vertex array to a Maple Array */
     vertexArray = convertArrayToMaple(vertex,num_vertices);
@@ -299,6 +518,7 @@ void curveFit(void)
     /* extract the data pointer from the array */
     fit_size = RTableUpperBound(kv,r,1);
     fit = (double*)RTableDataBlock(kv,r);
+    fitDirty = 1;
 }
 
 /* OpenGL: draw the scene */
@@ -308,9 +528,11 @@ void CDECL renderScene(void)
 
     drawAxes();
     drawCoords();
-    drawLine(vertex,num_vertices,1);
+    uploadBuffer(&vertexVBO,vertex,num_vertices,&vertexDirty);
+    drawLine(vertexVBO,num_vertices,1);
     curveFit();
-    drawLine(fit,fit_size,0);
+    uploadBuffer(&fitVBO,fit,fit_size,&fitDirty);
+    drawLine(fitVBO,fit_size,0);
     drawTitle();
     glutSwapBuffers();
 }
@@ -334,6 +556,8 @@ void CDECL processMouse(int button, int state, int x, int y)
 	vertex[2*i+0] =  (double)(2*x-width)/width;
 	vertex[2*i+1] =  (double)(height-2*y)/height;
 	num_vertices++;
+	vertexDirty = 1;
+	glutPostRedisplay();
     }
 }
 
@@ -342,6 +566,7 @@ void CDECL setCursorPosition(int x, int y)
 {
     xPos =  (double)(2*x-width)/width;
     yPos =  (double)(height-2*y)/height;
+    glutPostRedisplay();
 }
 
 /* OpenGL: quit when 'q' is pressed, clear screen when 'c' is pressed */
@@ -352,6 +577,15 @@ void CDECL processKeys(unsigned char key, int x, int y)
     else if( key == 'c' || key == 'C' ) {
         num_vertices = 0;
         fit_size = 0;
+        vertexDirty = fitDirty = 1;
+        glutPostRedisplay();
+    }
+    else if( key == 'i' || key == 'I' ) {
+        incremental = !incremental;
+        incReset(INC_NONE);
+        refit = 1;
+        printf("incremental fitting %s\n",incremental ? "on" : "off");
+        glutPostRedisplay();
     }
 }
 
@@ -368,19 +602,9 @@ void CDECL pickCurveFittingFunction( int option )
     sprintf(fullname,"CurveFitting:-%s;",FitFunctionName);
     FitFunction = EvalMapleStatement(kv,fullname);
 
-    if( !FitFunction ) {
-        /* perhaps the Maple library couldn't be found? */
-        char *dir;
-
-        /* set libname to $MAPLE/lib if $MAPLE exists in the environment */
-        if( (dir=getenv("MAPLE")) || (dir=getenv("MAPLE_ROOT")) ) {
-	    char *libpath;
-	    libpath = (char*)malloc((5+strlen(dir))*sizeof(char));
-	    sprintf(libpath,"%s/lib",dir);
-	    MapleLibName(kv,ToMapleString(kv,libpath));
-	    FitFunction = EvalMapleStatement(kv,fullname);
-	}
-    }
+    /* the menu also runs once from initMaple, before the window exists */
+    if( glutGetWindow() )
+	glutPostRedisplay();
 }
 
 /* initialize OpenGL */
@@ -393,8 +617,9 @@ void initOpenGL( int argc, char **argv )
     glutInitWindowPosition(100,100);
     glutInitWindowSize(320,320);
     glutCreateWindow("Line");
+    /* no idle callback: the scene is redrawn only after input or a
+       data change (glutPostRedisplay), so an idle viewer costs no CPU */
     glutDisplayFunc(renderScene);
-    glutIdleFunc(renderScene);
     glutReshapeFunc(changeSize);
     glutKeyboardFunc(processKeys);
 
@@ -435,6 +660,11 @@ void initMaple( int argc, char *argv[] )
 	exit(1);
     }
 
+    /* set libname once, before the first library lookup, from $MAPLE,
+       $MAPLE_ROOT or /opt/maple* (validated and cached on disk by
+       common/libname.h) */
+    maple_libname_apply(kv);
+
     /* get the function and variable names */
     pickCurveFittingFunction(1);
     varX = ToMapleName(kv,"x",1);
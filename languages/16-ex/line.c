@@ -31,6 +31,7 @@
  *
  */
 
+#define GL_GLEXT_PROTOTYPES  /* glGenBuffers & co. (OpenGL 1.5) */
 #include <GL/glut.h>
 #include <GL/glu.h>
 #include <GL/gl.h>
@@ -38,6 +39,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "maplec.h"
+#include "../common/libname.h"
 
 #define FONT (void *)GLUT_BITMAP_8_BY_13
 
@@ -55,6 +57,12 @@ int num_vertices = 0, vertex_size = 0;
 int fit_size = 0;
 MKernelVector kv;
 char *FitFunctionName;
+
+/* OpenGL: vertex buffer objects for the picked points and the fitted
+   curve.  The data is uploaded only when it changes (a click or a
+   new fit), never once per frame. */
+GLuint vertexVBO = 0, fitVBO = 0;
+int vertexDirty = 1, fitDirty = 1;
 ALGEB FitFunction, varX, varEqn;
 
 static char *FitFunctions[6] = {
@@ -181,24 +189,37 @@ void drawTitle(void)
     glPopMatrix();
 }
 
-/* OpenGL: draws a curve from the points given */
-void drawLine( double *vertex, int num_vertices, int color )
+/* OpenGL: (re)uploads n (x,y) pairs into *vbo if they have changed */
+void uploadBuffer( GLuint *vbo, double *data, int n, int *dirty )
 {
-    int i;
+    if( !*vbo )
+	glGenBuffers(1,vbo);
+    if( !*dirty )
+	return;
+
+    glBindBuffer(GL_ARRAY_BUFFER,*vbo);
+    glBufferData(GL_ARRAY_BUFFER,2*n*sizeof(double),
+                 n > 0 ? data : NULL,GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER,0);
+    *dirty = 0;
+}
 
+/* OpenGL: draws a curve from the points stored in a vertex buffer */
+void drawLine( GLuint vbo, int num_vertices, int color )
+{
     if( num_vertices == 0 ) 
 	return;
 
+    glBindBuffer(GL_ARRAY_BUFFER,vbo);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2,GL_DOUBLE,0,(void*)0);
+
     if( color == 1 ) 
 	glColor3f(1.0,0.0,0.0);
     else
 	glColor3f(0.0,1.0,0.0);
 
-    glBegin(GL_LINE_STRIP);
-    for( i=0; i<num_vertices; ++i ) {
-	glVertex2d(vertex[2*i+0],vertex[2*i+1]);
-    }
-    glEnd();
+    glDrawArrays(GL_LINE_STRIP,0,num_vertices);
 
     if( color == 1 ) {
 	glColor3f(0.0,0.0,1.0);
@@ -208,11 +229,10 @@ void drawLine( double *vertex, int num_vertices, int color )
 	glColor3f(1.0,1.0,1.0);
 	glPointSize(3.0);
     }
-    glBegin(GL_POINTS);
-    for( i=0; i<num_vertices; ++i ) {
-	glVertex2d(vertex[2*i+0],vertex[2*i+1]);
-    }
-    glEnd();
+    glDrawArrays(GL_POINTS,0,num_vertices);
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER,0);
 }
 
 /* OpenMaple: Turns a C array into something Maple recognizes.
@@ -264,6 +284,7 @@ void curveFit(void)
     prev_num_vertices = num_vertices;
     prev_fit_function = FitFunctionName;
     fit_size = 0;  /* don't draw any curve if there is an error */
+    fitDirty = 1;
 
     /* convert the vertex array to a Maple Array */
     vertexArray = convertArrayToMaple(vertex,num_vertices);
@@ -299,6 +320,7 @@ void curveFit(void)
     /* extract the data pointer from the array */
     fit_size = RTableUpperBound(kv,r,1);
     fit = (double*)RTableDataBlock(kv,r);
+    fitDirty = 1;
 }
 
 /* OpenGL: draw the scene */
@@ -308,9 +330,11 @@ void CDECL renderScene(void)
 
     drawAxes();
     drawCoords();
-    drawLine(vertex,num_vertices,1);
+    uploadBuffer(&vertexVBO,vertex,num_vertices,&vertexDirty);
+    drawLine(vertexVBO,num_vertices,1);
     curveFit();
-    drawLine(fit,fit_size,0);
+    uploadBuffer(&fitVBO,fit,fit_size,&fitDirty);
+    drawLine(fitVBO,fit_size,0);
     drawTitle();
     glutSwapBuffers();
 }
@@ -334,6 +358,8 @@ void CDECL processMouse(int button, int state, int x, int y)
 	vertex[2*i+0] =  (double)(2*x-width)/width;
 	vertex[2*i+1] =  (double)(height-2*y)/height;
 	num_vertices++;
+	vertexDirty = 1;
+	glutPostRedisplay();
     }
 }
 
@@ -342,6 +368,7 @@ void CDECL setCursorPosition(int x, int y)
 {
     xPos =  (double)(2*x-width)/width;
     yPos =  (double)(height-2*y)/height;
+    glutPostRedisplay();
 }
 
 /* OpenGL: quit when 'q' is pressed, clear screen when 'c' is pressed */
@@ -352,6 +379,8 @@ void CDECL processKeys(unsigned char key, int x, int y)
     else if( key == 'c' || key == 'C' ) {
         num_vertices = 0;
         fit_size = 0;
+        vertexDirty = fitDirty = 1;
+        glutPostRedisplay();
     }
 }
 
@@ -368,19 +397,9 @@ void CDECL pickCurveFittingFunction( int option )
     sprintf(fullname,"CurveFitting:-%s;",FitFunctionName);
     FitFunction = EvalMapleStatement(kv,fullname);
 
-    if( !FitFunction ) {
-        /* perhaps the Maple library couldn't be found? */
-        char *dir;
-
-        /* set libname to $MAPLE/lib if $MAPLE exists in the environment */
-        if( (dir=getenv("MAPLE")) || (dir=getenv("MAPLE_ROOT")) ) {
-	    char *libpath;
-	    libpath = (char*)malloc((5+strlen(dir))*sizeof(char));
-	    sprintf(libpath,"%s/lib",dir);
-	    MapleLibName(kv,ToMapleString(kv,libpath));
-	    FitFunction = EvalMapleStatement(kv,fullname);
-	}
-    }
+    /* the menu also runs once from initMaple, before the window exists */
+    if( glutGetWindow() )
+	glutPostRedisplay();
 }
 
 /* initialize OpenGL */
@@ -393,8 +412,9 @@ void initOpenGL( int argc, char **argv )
     glutInitWindowPosition(100,100);
     glutInitWindowSize(320,320);
     glutCreateWindow("Line");
+    /* no idle callback: the scene is redrawn only after input or a
+       data change (glutPostRedisplay), so an idle viewer costs no CPU */
     glutDisplayFunc(renderScene);
-    glutIdleFunc(renderScene);
     glutReshapeFunc(changeSize);
     glutKeyboardFunc(processKeys);
 
@@ -435,6 +455,11 @@ void initMaple( int argc, char *argv[] )
 	exit(1);
     }
 
+    /* set libname once, before the first library lookup, from $MAPLE,
+       $MAPLE_ROOT or /opt/maple* (validated and cached on disk by
+       common/libname.h) */
+    maple_libname_apply(kv);
+
     /* get the function and variable names */
     pickCurveFittingFunction(1);
     varX = ToMapleName(kv,"x",1);
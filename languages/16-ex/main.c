@@ -1,16 +1,19 @@
 /* test_lazy.c
  *
- * Teste: Integral com estratégia LAZY de carregamento de biblioteca
+ * Teste: Integral com o libname configurado uma vez na partida
  * Baseado na abordagem do line.c
  *
- * Testa se consegue calcular integral sem configurar libname,
- * e configura apenas se necessário (como line.c faz)
+ * Antes, o teste avaliava sem libname, detectava a falha, configurava
+ * e avaliava de novo.  Agora o libname vem do resolver com cache em
+ * disco (common/libname.h) logo depois do StartMaple, e cada integral
+ * é avaliada uma única vez.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "maplec.h"
+#include "../common/libname.h"
 
 /* ============================================
  * CALLBACKS
@@ -31,58 +34,22 @@ static void M_DECL errorCallBack(void *data, M_INT offset, const char *msg)
 }
 
 /* ============================================
- * FUNÇÃO QUE TENTA CALCULAR INTEGRAL
- * Abordagem LAZY (como line.c)
+ * FUNÇÃO QUE CALCULA INTEGRAL
+ * Uma avaliação só: o libname já foi configurado no main
  * ============================================ */
 
-ALGEB calculate_integral_lazy(MKernelVector kv, const char* expression)
+ALGEB calculate_integral(MKernelVector kv, const char* expression)
 {
     ALGEB result;
-    char *maple_dir;
     
-    printf("\n=== Tentando calcular: %s ===\n", expression);
+    printf("\n=== Calculando: %s ===\n", expression);
     
-    /* PRIMEIRO: Tentar sem configurar nada */
-    printf("1. Tentativa SEM configurar libname...\n");
     result = EvalMapleStatement(kv, expression);
-    
-    /* Verificar se funcionou */
     if (!result || IsMapleNULL(kv, result)) {
         printf("   ❌ Retornou NULL - falhou!\n");
-        
-        /* SEGUNDO: Configurar libname e tentar novamente */
-        printf("\n2. Detectada falha - configurando libname...\n");
-        
-        /* Tentar via variável de ambiente (como line.c) */
-        if ((maple_dir = getenv("MAPLE")) || (maple_dir = getenv("MAPLE_ROOT"))) {
-            char *libpath;
-            libpath = (char*)malloc((5 + strlen(maple_dir)) * sizeof(char));
-            sprintf(libpath, "%s/lib", maple_dir);
-            
-            printf("   Configurando via $MAPLE: %s\n", libpath);
-            MapleLibName(kv, ToMapleString(kv, libpath));
-            free(libpath);
-        } else {
-            /* Fallback: caminho hardcoded */
-            printf("   $MAPLE não encontrado, usando hardcoded...\n");
-            EvalMapleStatement(kv, "libname := \"/opt/maple2021/lib\", libname;");
-        }
-        
-        printf("   ✓ Libname configurado\n");
-        
-        /* TERCEIRO: Tentar novamente */
-        printf("\n3. Nova tentativa APÓS configurar libname...\n");
-        result = EvalMapleStatement(kv, expression);
-        
-        if (!result || IsMapleNULL(kv, result)) {
-            printf("   ❌ Ainda falhou após configurar libname!\n");
-            return NULL;
-        } else {
-            printf("   ✅ SUCESSO após configurar libname!\n");
-        }
-    } else {
-        printf("   ✅ SUCESSO sem precisar configurar libname!\n");
+        return NULL;
     }
+    printf("   ✅ SUCESSO\n");
     
     return result;
 }
@@ -97,11 +64,11 @@ void run_tests(MKernelVector kv)
     
     printf("\n");
     printf("════════════════════════════════════════════════════════\n");
-    printf("  TESTE: Calculando Integrais com Lazy Loading\n");
+    printf("  TESTE: Calculando Integrais (libname na partida)\n");
     printf("════════════════════════════════════════════════════════\n");
     
     /* Teste 1: Integral simples */
-    result = calculate_integral_lazy(kv, "int(x^2, x=0..2);");
+    result = calculate_integral(kv, "int(x^2, x=0..2);");
     if (result) {
         printf("\n>>> Resultado: ");
         MapleALGEB_Printf(kv, "%a\n", result);
@@ -153,7 +120,7 @@ int main(int argc, char *argv[])
     };
     
     printf("╔════════════════════════════════════════════════════════╗\n");
-    printf("║  Teste: Lazy Loading de Bibliotecas Maple             ║\n");
+    printf("║  Teste: libname na partida (resolver + cache)         ║\n");
     printf("║  Estratégia do line.c aplicada a integrais            ║\n");
     printf("╚════════════════════════════════════════════════════════╝\n");
     
@@ -167,6 +134,16 @@ int main(int argc, char *argv[])
     
     printf("✅ Maple inicializado\n");
     
+    /* libname uma vez, antes da primeira avaliação: $MAPLE,
+       $MAPLE_ROOT ou /opt/maple*, via common/libname.h */
+    if (maple_libname_apply(kv) > 0) {
+        printf("   Configurando via resolver (cache em disco)\n");
+    } else {
+        /* Fallback: caminho hardcoded */
+        printf("   Maple não encontrado, usando hardcoded...\n");
+    }
+    printf("   ✓ Libname configurado\n");
+    
     /* Verificar variável de ambiente */
     char *maple_env = getenv("MAPLE");
     if (maple_env) {
@@ -15,6 +15,7 @@
  * - Botão direito: Menu de funções
  */
 
+#define GL_GLEXT_PROTOTYPES   /* glGenBuffers & co. (OpenGL 1.5) */
 #include <GL/glut.h>
 #include <GL/glu.h>
 #include <GL/gl.h>
@@ -22,10 +23,19 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
 #include "maplec.h"
+#include "../common/libname.h"
 
 #define FONT (void *)GLUT_BITMAP_8_BY_13
-#define MAX_POINTS 500
+#define MAX_POINTS 500       /* orçamento de pontos por curva */
+#define PLOT_COARSE 33       /* grade inicial do amostrador */
+#define PLOT_MAX_DEPTH 12    /* subdivisões por intervalo da grade */
+#define PLOT_TOL_PX 0.5      /* desvio máximo aceito, em pixels */
+#define PLOT_SPAN 12.0       /* altura da janela em unidades (glOrtho) */
 
 #ifdef _MSC_VER
   #define CDECL __cdecl
@@ -37,12 +47,15 @@
 double width = 640, height = 480;
 MKernelVector kv;
 
-/* Dados da função */
+/* Dados da função em exibição (thread do GLUT) */
 char *current_function = NULL;
-double *func_points = NULL;
-double *deriv_points = NULL;
 int num_points = 0;
 
+/* Buffers de vértices: f, f' e a faixa da integral sobem para o GL
+   uma vez por cálculo, não a cada quadro */
+enum { VBO_FUNC, VBO_DERIV, VBO_AREA, VBO_COUNT };
+static GLuint curve_vbo[VBO_COUNT];
+
 /* Estados de visualização */
 int show_derivative = 0;
 int show_integral = 0;
@@ -81,117 +94,372 @@ static void M_DECL errorCallBack(void *data, M_INT offset, const char *msg)
  * FUNÇÕES DE CÁLCULO COM MAPLE
  * ============================================ */
 
-void calculate_function_points(const char *function_str)
+/* Amostrador adaptativo de f e f' (plot_grid).  f e f' são montadas
+   (unapply) uma vez por função; sob evalhf, cada intervalo de uma
+   grade grossa de n0 pontos é subdividido (pilha explícita S, da
+   esquerda para a direita) enquanto o ponto médio de f ou de f' se
+   afasta da corda mais que tol, em unidades do mundo já cortadas à
+   janela, ou enquanto só parte dos pontos é finita (NaN/inf: refina
+   até perto da singularidade).  O orçamento total é N pontos.
+   O resultado é [A, m]: A é um Array float[8] C_order 2 x N x 2 com
+   (x, f(x)) no bloco [1,..] e (x, f'(x)) no bloco [2,..], no layout
+   de PointBuffer func/deriv, e m é o número de pontos usados.  Se
+   evalhf recusar a expressão, cai na grade uniforme de N pontos. */
+static const char *GridProcSource =
+    "plot_fill := proc(f, df, a, b, n, A) "
+    "    local h, i, t; "
+    "    h := (b - a)/(n - 1); "
+    "    for i to n do "
+    "        t := a + (i - 1)*h; "
+    "        A[1, i, 1] := t; A[1, i, 2] := f(t); "
+    "        A[2, i, 1] := t; A[2, i, 2] := df(t); "
+    "    end do; "
+    "    n "
+    "end proc: "
+    "plot_clip := proc(y) "
+    "    if y > 10 then 10 elif y < -10 then -10 else y end if "
+    "end proc: "
+    "plot_err := proc(ya, ym, yb) "
+    "    local k; "
+    "    k := 0; "
+    "    if abs(ya) < 1e300 then k := k + 1 end if; "
+    "    if abs(ym) < 1e300 then k := k + 1 end if; "
+    "    if abs(yb) < 1e300 then k := k + 1 end if; "
+    "    if k = 0 then return 0 end if; "
+    "    if k < 3 then return 1e300 end if; "
+    "    abs(plot_clip(ym) - (plot_clip(ya) + plot_clip(yb))/2) "
+    "end proc: "
+    "plot_adapt := proc(f, df, a, b, n0, tol, maxdepth, N, A, S) "
+    "    local h, i, m, top, xa, ya, da, xb, yb, db, xm, ym, dm, lev, e; "
+    "    h := (b - a)/(n0 - 1); "
+    "    xa := a; ya := f(xa); da := df(xa); "
+    "    m := 1; "
+    "    A[1, 1, 1] := xa; A[1, 1, 2] := ya; "
+    "    A[2, 1, 1] := xa; A[2, 1, 2] := da; "
+    "    for i to n0 - 1 do "
+    "        xb := a + i*h; "
+    "        top := 1; "
+    "        S[1, 1] := xa; S[1, 2] := ya; S[1, 3] := da; "
+    "        S[1, 4] := xb; S[1, 5] := f(xb); S[1, 6] := df(xb); "
+    "        S[1, 7] := 0; "
+    "        while top > 0 do "
+    "            xa := S[top, 1]; ya := S[top, 2]; da := S[top, 3]; "
+    "            xb := S[top, 4]; yb := S[top, 5]; db := S[top, 6]; "
+    "            lev := S[top, 7]; "
+    "            top := top - 1; "
+    "            if lev < maxdepth and m + top + n0 - i + 1 <= N then "
+    "                xm := (xa + xb)/2; ym := f(xm); dm := df(xm); "
+    "                e := max(plot_err(ya, ym, yb), plot_err(da, dm, db)); "
+    "                if e > tol then "
+    "                    top := top + 1; "
+    "                    S[top, 1] := xm; S[top, 2] := ym; S[top, 3] := dm; "
+    "                    S[top, 4] := xb; S[top, 5] := yb; S[top, 6] := db; "
+    "                    S[top, 7] := lev + 1; "
+    "                    top := top + 1; "
+    "                    S[top, 1] := xa; S[top, 2] := ya; S[top, 3] := da; "
+    "                    S[top, 4] := xm; S[top, 5] := ym; S[top, 6] := dm; "
+    "                    S[top, 7] := lev + 1; "
+    "                    next; "
+    "                end if; "
+    "                m := m + 1; "
+    "                A[1, m, 1] := xm; A[1, m, 2] := ym; "
+    "                A[2, m, 1] := xm; A[2, m, 2] := dm; "
+    "            end if; "
+    "            m := m + 1; "
+    "            A[1, m, 1] := xb; A[1, m, 2] := yb; "
+    "            A[2, m, 1] := xb; A[2, m, 2] := db; "
+    "        end do; "
+    "        xa := xb; ya := yb; da := db; "
+    "    end do; "
+    "    m "
+    "end proc: "
+    "plot_grid := proc(e, a, b, n0, tol, maxdepth, N) "
+    "    local f, df, A, S, m; "
+    "    f := unapply(e, :-x); "
+    "    df := unapply(diff(e, :-x), :-x); "
+    "    A := Array(1..2, 1..N, 1..2, datatype=float[8], order=C_order); "
+    "    S := Array(1..maxdepth + 2, 1..7, datatype=float[8]); "
+    "    try "
+    "        m := evalhf(plot_adapt(f, df, a, b, n0, tol, maxdepth, "
+    "                               N, var(A), var(S))); "
+    "    catch: "
+    "        m := plot_fill(f, df, a, b, N, A); "
+    "    end try; "
+    "    [A, trunc(m)] "
+    "end proc;";
+
+static ALGEB grid_proc = NULL;    /* plot_grid, criado em initMaple */
+
+/* ============================================
+ * THREAD DO MAPLE
+ * ============================================
+ *
+ * Só a thread worker toca no kernel (kv).  A thread do GLUT:
+ *   - enfileira pedidos numa fila SPSC sem lock (job_push) e acorda
+ *     o worker com sem_post, que nunca bloqueia;
+ *   - recebe os pontos prontos trocando um ponteiro (ready_buffer)
+ *     e só copia os dados para os VBOs;
+ *   - cancela o cálculo em andamento incrementando job_seq, que o
+ *     Maple consulta pelo callback queryInterrupt.
+ */
+
+typedef struct {
+    const char *function;
+    unsigned long seq;
+    double tol;           /* PLOT_TOL_PX em unidades do mundo */
+} PlotJob;
+
+#define JOB_QUEUE_SIZE 16   /* potência de 2 */
+
+static PlotJob job_queue[JOB_QUEUE_SIZE];
+static atomic_uint job_head;          /* próximo a ler (worker) */
+static atomic_uint job_tail;          /* próximo a escrever (GLUT) */
+static atomic_ulong job_seq;          /* último pedido feito */
+static atomic_ulong running_seq;      /* pedido em cálculo; 0: nenhum */
+static atomic_ulong done_seq;         /* último pedido tratado (worker) */
+static unsigned long requested_seq;   /* último request_function (GLUT) */
+static sem_t job_sem;
+
+/* Resultado de um cálculo.  Os pontos vivem no Array do Maple
+   (rtable), protegido do GC enquanto o buffer estiver em uso. */
+enum { BUF_FREE, BUF_READY, BUF_READING };
+
+typedef struct {
+    atomic_int state;
+    ALGEB rtable;
+    double *func;         /* (x, f(x)) */
+    double *deriv;        /* (x, f'(x)) */
+    int n;
+    double integral;
+    unsigned long seq;
+    const char *function; /* pedido que gerou o buffer (chave do cache) */
+    double tol;
+} PointBuffer;
+
+static PointBuffer point_buffers[2];
+static _Atomic(PointBuffer *) ready_buffer = NULL;
+
+/* produtor: thread do GLUT */
+static int job_push(const char *function, unsigned long seq, double tol)
 {
-    ALGEB result;
-    char maple_cmd[512];
-    int i;
-    double x, step;
-    
-    if (!function_str) return;
-    
-    printf("Calculando função: %s\n", function_str);
-    
-    /* Limpar pontos antigos */
-    if (func_points) {
-        free(func_points);
-        func_points = NULL;
+    unsigned tail = atomic_load(&job_tail);
+    if (tail - atomic_load(&job_head) == JOB_QUEUE_SIZE)
+        return 0;
+    job_queue[tail & (JOB_QUEUE_SIZE - 1)].function = function;
+    job_queue[tail & (JOB_QUEUE_SIZE - 1)].seq = seq;
+    job_queue[tail & (JOB_QUEUE_SIZE - 1)].tol = tol;
+    atomic_store(&job_tail, tail + 1);
+    return 1;
+}
+
+/* consumidor: worker */
+static int job_pop(PlotJob *job)
+{
+    unsigned head = atomic_load(&job_head);
+    if (head == atomic_load(&job_tail))
+        return 0;
+    *job = job_queue[head & (JOB_QUEUE_SIZE - 1)];
+    atomic_store(&job_head, head + 1);
+    return 1;
+}
+
+/* Tolerância do amostrador para o tamanho atual da janela (janela
+   minimizada: altura 0, tratada como 1 para não virar inf) */
+static double current_tol(void)
+{
+    return PLOT_TOL_PX * PLOT_SPAN / (height > 1 ? height : 1);
+}
+
+/* Pede o cálculo de uma função; nunca bloqueia.  Um pedido novo
+   cancela o anterior. */
+static void request_function(const char *function)
+{
+    unsigned long seq = atomic_fetch_add(&job_seq, 1) + 1;
+    requested_seq = seq;
+    if (!job_push(function, seq, current_tol())) {
+        fprintf(stderr, "Fila de cálculo cheia, pedido descartado\n");
+        return;
     }
-    if (deriv_points) {
-        free(deriv_points);
-        deriv_points = NULL;
+    sem_post(&job_sem);
+}
+
+/* O pedido em cálculo foi superado por um mais novo?  Fora de um
+   cálculo (running_seq == 0: partida do kernel, libname, definição
+   do plot_grid) nada é cancelável. */
+static int job_cancelled(void)
+{
+    unsigned long running = atomic_load(&running_seq);
+    return running != 0 && running != atomic_load(&job_seq);
+}
+
+/* Chamado pelo Maple durante cálculos longos */
+static M_BOOL M_DECL queryInterrupt(void *data)
+{
+    (void)data;
+    return job_cancelled();
+}
+
+/* Worker: pega um buffer livre (no máximo um está em leitura e
+   outro publicado; o render devolve o seu logo após o upload) */
+static PointBuffer *acquire_buffer(void)
+{
+    struct timespec nap = { 0, 1000000 };
+    for (;;) {
+        int i;
+        for (i = 0; i < 2; i++)
+            if (atomic_load(&point_buffers[i].state) == BUF_FREE)
+                return &point_buffers[i];
+        nanosleep(&nap, NULL);
     }
+}
+
+/* Limitar valores extremos (in-place no bloco de dados do Maple).
+   NaN/inf ficam como estão: viram quebras da curva no desenho. */
+static void clamp_points(double *points, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++) {
+        double y = points[2*i + 1];
+        if (isfinite(y)) {      /* +inf > 10.0 também seria cortado */
+            if (y > 10.0) y = 10.0;
+            else if (y < -10.0) y = -10.0;
+            points[2*i + 1] = y;
+        }
+    }
+}
+
+/* Calcula integral, f e f' para `job` em `buf` (thread worker).
+   Devolve 0 se houve erro ou o pedido foi cancelado. */
+static int calculate_function_points(const PlotJob *job, PointBuffer *buf)
+{
+    ALGEB result, expr;
+    char maple_cmd[512];
+    double *data;
+    int n;
     
-    num_points = MAX_POINTS;
-    func_points = (double*)malloc(2 * num_points * sizeof(double));
-    deriv_points = (double*)malloc(2 * num_points * sizeof(double));
+    printf("Calculando função: %s\n", job->function);
     
-    if (!func_points || !deriv_points) {
-        printf("Erro ao alocar memória!\n");
-        return;
+    /* O Array anterior deste buffer volta ao coletor */
+    if (buf->rtable) {
+        MapleGcAllow(kv, buf->rtable);
+        buf->rtable = NULL;
     }
     
-    /* Definir a função no Maple */
-    sprintf(maple_cmd, "f := x -> %s:", function_str);
-    result = EvalMapleStatement(kv, maple_cmd);
-    if (!result) {
-        printf("Erro ao definir função no Maple\n");
-        return;
+    if (!grid_proc) {
+        printf("Erro: plot_grid não definido no Maple\n");
+        return 0;
     }
     
-    /* Calcular derivada */
-    sprintf(maple_cmd, "df := diff(%s, x):", function_str);
-    result = EvalMapleStatement(kv, maple_cmd);
-    if (!result) {
-        printf("Erro ao calcular derivada\n");
-        return;
+    /* Expressão da função (parse único).  Protegida do GC até a
+       chamada do plot_grid: a integral abaixo aloca bastante e
+       poderia coletá-la. */
+    sprintf(maple_cmd, "%s;", job->function);
+    expr = EvalMapleStatement(kv, maple_cmd);
+    if (!expr) {
+        printf("Erro ao definir função no Maple\n");
+        return 0;
     }
+    MapleGcProtect(kv, expr);
     
     /* Calcular integral de x_min a x_max */
     sprintf(maple_cmd, "int_val := evalf(int(%s, x=%f..%f)):", 
-            function_str, x_min, x_max);
+            job->function, x_min, x_max);
     result = EvalMapleStatement(kv, maple_cmd);
+    if (job_cancelled()) {
+        MapleGcAllow(kv, expr);
+        return 0;
+    }
     
     /* Extrair valor da integral */
+    buf->integral = 0.0;
     result = EvalMapleStatement(kv, "int_val;");
     if (result && !IsMapleNULL(kv, result)) {
         char *str_result = MapleToString(kv, result);
         if (str_result && strlen(str_result) > 0) {
-            integral_value = atof(str_result);
-            printf("Integral [%.2f, %.2f] = %f\n", x_min, x_max, integral_value);
+            buf->integral = atof(str_result);
+            printf("Integral [%.2f, %.2f] = %f\n", x_min, x_max, buf->integral);
         }
     }
     
-    /* Calcular pontos da função e derivada */
-    step = (x_max - x_min) / (num_points - 1);
-    
-    for (i = 0; i < num_points; i++) {
-        x = x_min + i * step;
-        
-        func_points[2*i] = x;
-        deriv_points[2*i] = x;
-        
-        /* Avaliar f(x) */
-        sprintf(maple_cmd, "evalf(subs(x=%f, %s));", x, function_str);
-        result = EvalMapleStatement(kv, maple_cmd);
-        
-        if (result && !IsMapleNULL(kv, result)) {
-            char *str_val = MapleToString(kv, result);
-            if (str_val && strlen(str_val) > 0) {
-                double y = atof(str_val);
-                /* Limitar valores extremos */
-                if (y > 10.0) y = 10.0;
-                else if (y < -10.0) y = -10.0;
-                else if (isnan(y) || isinf(y)) y = 0.0;
-                func_points[2*i + 1] = y;
-            } else {
-                func_points[2*i + 1] = 0.0;
-            }
-        } else {
-            func_points[2*i + 1] = 0.0;
+    /* Amostrar f e f' (adaptativo) numa única chamada */
+    result = EvalMapleProc(kv, grid_proc, 7, expr,
+                           ToMapleFloat(kv, x_min),
+                           ToMapleFloat(kv, x_max),
+                           ToMapleInteger(kv, PLOT_COARSE),
+                           ToMapleFloat(kv, job->tol),
+                           ToMapleInteger(kv, PLOT_MAX_DEPTH),
+                           ToMapleInteger(kv, MAX_POINTS));
+    MapleGcAllow(kv, expr);
+    if (job_cancelled()) {
+        printf("Cálculo de %s cancelado\n", job->function);
+        return 0;
+    }
+    if (!result || !IsMapleList(kv, result)) {
+        printf("Erro ao calcular pontos da função\n");
+        return 0;
+    }
+    n = MapleToInteger32(kv, MapleListSelect(kv, result, 2));
+    result = MapleListSelect(kv, result, 1);
+    
+    /* Sem cópia: os ponteiros apontam para o bloco do Array, que fica
+       protegido do GC até o buffer ser reaproveitado.  O bloco de f'
+       começa depois das MAX_POINTS posições reservadas para f. */
+    MapleGcProtect(kv, result);
+    buf->rtable = result;
+    data = (double*)RTableDataBlock(kv, result);
+    buf->func = data;
+    buf->deriv = data + 2 * MAX_POINTS;
+    buf->n = n;
+    buf->seq = job->seq;
+    buf->function = job->function;
+    buf->tol = job->tol;
+    
+    clamp_points(buf->func, n);
+    clamp_points(buf->deriv, n);
+    
+    printf("✓ %d pontos calculados (máx. %d)\n", n, MAX_POINTS);
+    return 1;
+}
+
+static void initMaple(int argc, char *argv[]);
+
+static int worker_argc;
+static char **worker_argv;
+
+static void *maple_worker(void *arg)
+{
+    (void)arg;
+    initMaple(worker_argc, worker_argv);
+
+    for (;;) {
+        PlotJob job, next;
+        PointBuffer *buf, *old;
+
+        sem_wait(&job_sem);
+        if (!job_pop(&job)) continue;
+        /* pula pedidos já superados na fila */
+        while (job_pop(&next)) {
+            sem_trywait(&job_sem);
+            job = next;
         }
-        
-        /* Avaliar df/dx */
-        sprintf(maple_cmd, "evalf(subs(x=%f, df));", x);
-        result = EvalMapleStatement(kv, maple_cmd);
-        
-        if (result && !IsMapleNULL(kv, result)) {
-            char *str_val = MapleToString(kv, result);
-            if (str_val && strlen(str_val) > 0) {
-                double dy = atof(str_val);
-                if (dy > 10.0) dy = 10.0;
-                else if (dy < -10.0) dy = -10.0;
-                else if (isnan(dy) || isinf(dy)) dy = 0.0;
-                deriv_points[2*i + 1] = dy;
-            } else {
-                deriv_points[2*i + 1] = 0.0;
-            }
-        } else {
-            deriv_points[2*i + 1] = 0.0;
+        if (job.seq != atomic_load(&job_seq)) {
+            atomic_store(&done_seq, job.seq);
+            continue;
         }
+
+        atomic_store(&running_seq, job.seq);
+        buf = acquire_buffer();
+        if (calculate_function_points(&job, buf)) {
+            /* publica; um resultado ainda não lido é descartado */
+            atomic_store(&buf->state, BUF_READY);
+            old = atomic_exchange(&ready_buffer, buf);
+            if (old) atomic_store(&old->state, BUF_FREE);
+        }
+        atomic_store(&running_seq, 0);
+        atomic_store(&done_seq, job.seq);
     }
-    
-    printf("✓ %d pontos calculados\n", num_points);
+    return NULL;
 }
 
 /* ============================================
@@ -200,7 +468,7 @@ void calculate_function_points(const char *function_str)
 
 void CDECL changeSize(int w, int h) 
 {
-    if (h < 0) h = 1;
+    if (h <= 0) h = 1;
     width = w;
     height = h;
 
@@ -247,27 +515,254 @@ void drawAxes(void)
     }
 }
 
-void drawFunction(double *points, int n, float r, float g, float b, float width_line)
+/* Trechos contínuos de uma curva, para glMultiDrawArrays */
+typedef struct {
+    GLint first[MAX_POINTS];
+    GLsizei count[MAX_POINTS];
+    int n;
+} CurveSegments;
+
+static CurveSegments func_segs, deriv_segs, area_segs;
+
+/* Quebra a curva em pontos NaN/inf e em saltos de um lado ao outro
+   da janela (polos, como em 1/x), em vez de ligá-los por retas. */
+static void build_segments(const double *p, int n, CurveSegments *s)
+{
+    int i, open = 0;
+
+    s->n = 0;
+    for (i = 0; i < n; i++) {
+        double y = p[2*i + 1];
+        if (!isfinite(y)) {
+            open = 0;
+            continue;
+        }
+        if (open) {
+            double yp = p[2*i - 1];
+            if (fabs(yp) >= 10.0 && fabs(y) >= 10.0 && yp * y < 0.0)
+                open = 0;
+        }
+        if (!open) {
+            s->first[s->n] = i;
+            s->count[s->n] = 0;
+            s->n++;
+            open = 1;
+        }
+        s->count[s->n - 1]++;
+    }
+}
+
+/* Copia n pontos de f e f' para os VBOs e monta os trechos */
+static void upload_curves(const double *func, const double *deriv, int n)
 {
+    double *area;
     int i;
-    
-    if (!points || n == 0) return;
+
+    if (!curve_vbo[0]) glGenBuffers(VBO_COUNT, curve_vbo);
+
+    glBindBuffer(GL_ARRAY_BUFFER, curve_vbo[VBO_FUNC]);
+    glBufferData(GL_ARRAY_BUFFER, 2 * n * sizeof(double),
+                 func, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, curve_vbo[VBO_DERIV]);
+    glBufferData(GL_ARRAY_BUFFER, 2 * n * sizeof(double),
+                 deriv, GL_STATIC_DRAW);
+
+    /* faixa da integral: (x, 0), (x, f(x)) para GL_TRIANGLE_STRIP */
+    area = malloc(4 * (n > 0 ? n : 1) * sizeof(double));
+    if (area) {
+        for (i = 0; i < n; i++) {
+            area[4*i + 0] = func[2*i];
+            area[4*i + 1] = 0.0;
+            area[4*i + 2] = func[2*i];
+            area[4*i + 3] = func[2*i + 1];
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, curve_vbo[VBO_AREA]);
+        glBufferData(GL_ARRAY_BUFFER, 4 * n * sizeof(double),
+                     area, GL_STATIC_DRAW);
+        free(area);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    build_segments(func, n, &func_segs);
+    build_segments(deriv, n, &deriv_segs);
+    area_segs.n = func_segs.n;
+    for (i = 0; i < func_segs.n; i++) {
+        area_segs.first[i] = 2 * func_segs.first[i];
+        area_segs.count[i] = 2 * func_segs.count[i];
+    }
+}
+
+/* ============================================
+ * CACHE DE RESULTADOS (LRU)
+ * ============================================
+ *
+ * Trocar entre funções do menu não deve recalcular nada: cada
+ * resultado (cópia de f, f' e integral) fica guardado, na thread do
+ * GLUT, com chave (função, intervalo, orçamento de pontos,
+ * tolerância).  Com o cache cheio sai a entrada usada há mais tempo.
+ */
+
+#define PLOT_CACHE_SLOTS 8
+
+typedef struct {
+    const char *function;     /* NULL = livre */
+    double a, b;
+    int budget;
+    double tol;
+    int n;
+    double *func;             /* 2*n doubles */
+    double *deriv;            /* 2*n doubles */
+    double integral;
+    unsigned long used;       /* relógio LRU */
+} PlotCacheEntry;
+
+static PlotCacheEntry plot_cache[PLOT_CACHE_SLOTS];
+static unsigned long plot_cache_clock = 0;
+static unsigned long plot_cache_hits = 0, plot_cache_misses = 0;
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static PlotCacheEntry *cache_lookup(const char *function, double tol)
+{
+    int i;
+
+    for (i = 0; i < PLOT_CACHE_SLOTS; i++) {
+        PlotCacheEntry *e = &plot_cache[i];
+        if (e->function && strcmp(e->function, function) == 0
+            && e->a == x_min && e->b == x_max
+            && e->budget == MAX_POINTS && e->tol == tol) {
+            e->used = ++plot_cache_clock;
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void cache_store(const PointBuffer *b)
+{
+    PlotCacheEntry *e = &plot_cache[0];
+    size_t bytes = 2 * (size_t)b->n * sizeof(double);
+    double *func, *deriv;
+    int i;
+
+    if (cache_lookup(b->function, b->tol)) return;
+
+    for (i = 1; i < PLOT_CACHE_SLOTS; i++)
+        if (plot_cache[i].used < e->used) e = &plot_cache[i];
+
+    func = malloc(bytes ? bytes : 1);
+    deriv = malloc(bytes ? bytes : 1);
+    if (!func || !deriv) {
+        free(func);
+        free(deriv);
+        return;
+    }
+    memcpy(func, b->func, bytes);
+    memcpy(deriv, b->deriv, bytes);
+
+    free(e->func);
+    free(e->deriv);
+    e->function = b->function;
+    e->a = x_min;
+    e->b = x_max;
+    e->budget = MAX_POINTS;
+    e->tol = b->tol;
+    e->n = b->n;
+    e->func = func;
+    e->deriv = deriv;
+    e->integral = b->integral;
+    e->used = ++plot_cache_clock;
+}
+
+/* Mostra `function` direto do cache, se estiver lá.  Um pedido ainda
+   em andamento no worker é cancelado. */
+static int show_cached(const char *function)
+{
+    double t0 = now_ms();
+    PlotCacheEntry *e = cache_lookup(function, current_tol());
+
+    if (!e) {
+        plot_cache_misses++;
+        return 0;
+    }
+    plot_cache_hits++;
+    atomic_fetch_add(&job_seq, 1);
+    upload_curves(e->func, e->deriv, e->n);
+    num_points = e->n;
+    integral_value = e->integral;
+    printf("Cache: %s em %.3f ms (%lu acertos, %lu faltas)\n",
+           function, now_ms() - t0, plot_cache_hits, plot_cache_misses);
+    return 1;
+}
+
+/* Pega o resultado publicado pelo worker, se houver; nunca espera.
+   Resultados de pedidos já superados são ignorados. */
+static int poll_results(void)
+{
+    PointBuffer *b = atomic_exchange(&ready_buffer, NULL);
+    int fresh;
+
+    if (!b) return 0;
+    atomic_store(&b->state, BUF_READING);
+    fresh = b->seq == atomic_load(&job_seq);
+    if (fresh) {
+        upload_curves(b->func, b->deriv, b->n);
+        num_points = b->n;
+        integral_value = b->integral;
+        cache_store(b);
+    }
+    atomic_store(&b->state, BUF_FREE);
+    return fresh;
+}
+
+/* Sem idle: enquanto há pedido pendente, um timer consulta o worker */
+static int poll_armed = 0;
+
+static void CDECL pollWorker(int value)
+{
+    (void)value;
+    poll_armed = 0;
+    if (poll_results())
+        glutPostRedisplay();
+    if (atomic_load(&done_seq) < requested_seq
+        || atomic_load(&ready_buffer)) {
+        poll_armed = 1;
+        glutTimerFunc(30, pollWorker, 0);
+    }
+}
+
+static void schedule_poll(void)
+{
+    if (!poll_armed) {
+        poll_armed = 1;
+        glutTimerFunc(30, pollWorker, 0);
+    }
+}
+
+/* Desenha os trechos de vértices (x, y) de um VBO */
+static void drawBuffer(GLuint vbo, GLenum mode, const CurveSegments *s)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_DOUBLE, 0, (void *)0);
+    glMultiDrawArrays(mode, s->first, s->count, s->n);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void drawFunction(GLuint vbo, const CurveSegments *s, float r, float g, float b, float width_line)
+{
+    if (s->n == 0) return;
     
     glColor3f(r, g, b);
     glLineWidth(width_line);
-    
-    glBegin(GL_LINE_STRIP);
-    for (i = 0; i < n; i++) {
-        double x = points[2*i];
-        double y = points[2*i + 1];
-        
-        /* Pular valores inválidos */
-        if (isnan(y) || isinf(y)) continue;
-        
-        glVertex2d(x, y);
-    }
-    glEnd();
-    
+    drawBuffer(vbo, GL_LINE_STRIP, s);
     glLineWidth(1.0f);
 }
 
@@ -313,33 +808,21 @@ void CDECL renderScene(void)
     drawAxes();
     
     /* Desenhar função principal */
-    if (func_points && num_points > 0) {
-        drawFunction(func_points, num_points, 0.0f, 0.5f, 1.0f, 2.0f);
+    if (num_points > 0) {
+        drawFunction(curve_vbo[VBO_FUNC], &func_segs, 0.0f, 0.5f, 1.0f, 2.0f);
     }
     
     /* Desenhar derivada */
-    if (show_derivative && deriv_points && num_points > 0) {
-        drawFunction(deriv_points, num_points, 0.0f, 1.0f, 0.0f, 1.5f);
+    if (show_derivative && num_points > 0) {
+        drawFunction(curve_vbo[VBO_DERIV], &deriv_segs, 0.0f, 1.0f, 0.0f, 1.5f);
     }
     
-    /* Desenhar área da integral (simplificado) */
-    if (show_integral && func_points && num_points > 0) {
-        int i;
+    /* Desenhar área da integral (a grade inteira está em [x_min, x_max]) */
+    if (show_integral && num_points > 0) {
         glColor4f(0.0f, 1.0f, 1.0f, 0.2f);
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        
-        glBegin(GL_TRIANGLE_STRIP);
-        for (i = 0; i < num_points; i++) {
-            double x = func_points[2*i];
-            double y = func_points[2*i + 1];
-            if (x >= x_min && x <= x_max && !isnan(y) && !isinf(y)) {
-                glVertex2d(x, 0.0);
-                glVertex2d(x, y);
-            }
-        }
-        glEnd();
-        
+        drawBuffer(curve_vbo[VBO_AREA], GL_TRIANGLE_STRIP, &area_segs);
         glDisable(GL_BLEND);
     }
     
@@ -360,10 +843,8 @@ void CDECL processKeys(unsigned char key, int x, int y)
         exit(0);
     }
     else if (key == 'c' || key == 'C') {
-        if (func_points) free(func_points);
-        if (deriv_points) free(deriv_points);
-        func_points = NULL;
-        deriv_points = NULL;
+        /* cancela o cálculo em andamento; o worker descarta o resto */
+        atomic_fetch_add(&job_seq, 1);
         num_points = 0;
         current_function = NULL;
         show_integral = 0;
@@ -377,12 +858,17 @@ void CDECL processKeys(unsigned char key, int x, int y)
         show_derivative = !show_derivative;
         printf("Derivada: %s\n", show_derivative ? "ON" : "OFF");
     }
+    glutPostRedisplay();
 }
 
 void CDECL pickFunction(int option) 
 {
     current_function = PresetFunctions[option];
-    calculate_function_points(current_function);
+    if (!show_cached(current_function)) {
+        request_function(current_function);   /* não bloqueia */
+        schedule_poll();
+    }
+    glutPostRedisplay();
 }
 
 /* ============================================
@@ -399,8 +885,9 @@ void initOpenGL(int argc, char **argv)
     glutInitWindowSize(640, 480);
     glutCreateWindow("Plotador de Funções - OpenMaple");
     
+    /* Sem glutIdleFunc: redesenha só após entrada ou novos dados
+       (glutPostRedisplay), então a janela parada não gasta CPU */
     glutDisplayFunc(renderScene);
-    glutIdleFunc(renderScene);
     glutReshapeFunc(changeSize);
     glutKeyboardFunc(processKeys);
 
@@ -419,11 +906,12 @@ void initOpenGL(int argc, char **argv)
     glMatrixMode(GL_MODELVIEW);
 }
 
-void initMaple(int argc, char *argv[])
+/* Roda na thread worker, dona do kernel */
+static void initMaple(int argc, char *argv[])
 {
-    MCallBackVectorDesc cb = { textCallBack, errorCallBack, 0, 0, 0, 0, 0, 0 };
+    MCallBackVectorDesc cb = { textCallBack, errorCallBack, 0, 0, 0, 0,
+                               queryInterrupt, 0 };
     char err[2048];
-    char *maple_dir;
 
     if ((kv = StartMaple(argc, argv, &cb, NULL, NULL, err)) == NULL) {
         printf("Erro ao inicializar Maple: %s\n", err);
@@ -432,18 +920,31 @@ void initMaple(int argc, char *argv[])
     
     printf("✓ Maple inicializado\n");
 
-    /* Configurar libname (lazy, como line.c) */
-    if ((maple_dir = getenv("MAPLE")) || (maple_dir = getenv("MAPLE_ROOT"))) {
-        char *libpath = malloc((5 + strlen(maple_dir)) * sizeof(char));
-        sprintf(libpath, "%s/lib", maple_dir);
-        MapleLibName(kv, ToMapleString(kv, libpath));
-        free(libpath);
-        printf("✓ Libname configurado via $MAPLE\n");
+    /* Configurar libname: $MAPLE, $MAPLE_ROOT ou /opt/maple*, com
+       cache em disco (common/libname.h) */
+    if (maple_libname_apply(kv) > 0)
+        printf("✓ Libname configurado\n");
+    
+    /* Definir o amostrador em lote (uma vez por sessão) */
+    grid_proc = EvalMapleStatement(kv, GridProcSource);
+    if (grid_proc && IsMapleProcedure(kv, grid_proc))
+        MapleGcProtect(kv, grid_proc);
+    else
+        grid_proc = NULL;
+}
+
+static void startMapleWorker(int argc, char **argv)
+{
+    pthread_t tid;
+
+    worker_argc = argc;
+    worker_argv = argv;
+    sem_init(&job_sem, 0, 0);
+    if (pthread_create(&tid, NULL, maple_worker, NULL) != 0) {
+        printf("Erro ao criar a thread do Maple\n");
+        exit(1);
     }
-    
-    /* Testar com função inicial */
-    current_function = PresetFunctions[0];
-    calculate_function_points(current_function);
+    pthread_detach(tid);
 }
 
 /* ============================================
@@ -457,8 +958,13 @@ int main(int argc, char **argv)
     printf("║  OpenMaple + OpenGL                                    ║\n");
     printf("╚════════════════════════════════════════════════════════╝\n\n");
     
-    initMaple(argc, argv);
     initOpenGL(argc, argv);
+    startMapleWorker(argc, argv);
+    
+    /* Testar com função inicial (calculada em segundo plano) */
+    current_function = PresetFunctions[0];
+    request_function(current_function);
+    schedule_poll();
     
     printf("\nControles:\n");
     printf("  i - Mostrar/esconder integral\n");
@@ -1,6 +1,7 @@
 /*  plotfunc.c  –  Plotador Interativo de Funções com OpenMaple + OpenGL
  *  CORRIGIDO – evita segfault nas funções de desenho e avaliação Maple
  */
+#define GL_GLEXT_PROTOTYPES          /* glGenBuffers & co. (GL 1.5) */
 #include <GL/glut.h>
 #include <GL/glu.h>
 #include <GL/gl.h>
@@ -9,10 +10,15 @@
 #include <string.h>
 #include <math.h>
 #include <errno.h>
+#include <time.h>
 #include "maplec.h"
 
 #define FONT (void *)GLUT_BITMAP_8_BY_13
-#define MAX_POINTS 500
+#define MAX_POINTS 500       /* orçamento de pontos por curva */
+#define PLOT_COARSE 33       /* grade inicial do amostrador */
+#define PLOT_MAX_DEPTH 12    /* subdivisões por intervalo */
+#define PLOT_TOL_PX 0.5      /* desvio máximo, em pixels */
+#define PLOT_SPAN 12.0       /* altura da janela em unidades */
 
 #ifdef _MSC_VER
 # define CDECL __cdecl
@@ -34,6 +40,11 @@ static int show_integral   = 0;
 static double integral_value = 0.0;
 static double x_min = -5.0, x_max = 5.0;
 
+/* VBOs: f, f' e faixa da integral, enviados só quando mudam */
+enum { VBO_FUNC, VBO_DERIV, VBO_AREA, VBO_COUNT };
+static GLuint curve_vbo[VBO_COUNT];
+static int    curves_dirty = 1;
+
 static char *PresetFunctions[] = {
     "sin(x)", "cos(x)", "x^2", "x^3 - 3*x",
     "exp(-x^2)", "1/(1+x^2)", "sin(x)/x", NULL
@@ -46,96 +57,342 @@ static void M_DECL textCallBack(void *data, int tag, const char *output)
 static void M_DECL errorCallBack(void *data, M_INT offset, const char *msg)
 { fprintf(stderr, "Maple Error: %s\n", msg); (void)data; (void)offset; }
 
-/* ----------  desenho – SAFE  ---------- */
-static void drawFunction(double *points, int n, float r, float g, float b, float lw)
+/* ----------  desenho – VBOs  ---------- */
+/* trechos contínuos de uma curva (glMultiDrawArrays) */
+typedef struct {
+    GLint   first[MAX_POINTS];
+    GLsizei count[MAX_POINTS];
+    int     n;
+} CurveSegments;
+
+static CurveSegments func_segs, deriv_segs, area_segs;
+
+/* quebra em NaN/inf e em saltos através da janela (polos) */
+static void build_segments(const double *p, int n, CurveSegments *s)
+{
+    int open = 0;
+    s->n = 0;
+    for (int i = 0; i < n; ++i) {
+        double y = p[2*i+1];
+        if (!isfinite(y)) { open = 0; continue; }
+        if (open && fabs(p[2*i-1]) >= 10.0 && fabs(y) >= 10.0 && p[2*i-1] * y < 0.0)
+            open = 0;
+        if (!open) { s->first[s->n] = i; s->count[s->n++] = 0; open = 1; }
+        s->count[s->n - 1]++;
+    }
+}
+
+static void drawBuffer(GLuint vbo, GLenum mode, const CurveSegments *s)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_DOUBLE, 0, (void *)0);
+    glMultiDrawArrays(mode, s->first, s->count, s->n);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+static void drawFunction(GLuint vbo, const CurveSegments *s, float r, float g, float b, float lw)
 {
-    if (!points || n <= 0) return;          /* 1ª proteção */
+    if (s->n <= 0) return;                  /* proteção */
 
     glColor3f(r, g, b);
     glLineWidth(lw);
-    glBegin(GL_LINE_STRIP);
+    drawBuffer(vbo, GL_LINE_STRIP, s);     /* NaN/inf ficam fora dos trechos */
+    glLineWidth(1.0f);
+}
+
+/* ----------  cálculo com Maple – em lote  ---------- */
+/* plot_grid: amostragem adaptativa de f e f' (unapply uma vez), sob
+   evalhf.  Cada intervalo de uma grade grossa de n0 pontos é dividido
+   ao meio (pilha S, esquerda -> direita) enquanto o ponto médio de f
+   ou f' se afasta da corda mais que tol (já cortado à janela) ou só
+   parte dos pontos é finita (NaN/inf).  Orçamento: N pontos.
+   Devolve [A, m]: A = Array float[8] C_order 2 x N x 2 (bloco 1 =
+   (x, f(x)), bloco 2 = (x, f'(x))), m = pontos usados.  Sem evalhf,
+   cai na grade uniforme de N pontos. */
+static const char *GridProcSource =
+    "plot_fill := proc(f, df, a, b, n, A) "
+    "    local h, i, t; "
+    "    h := (b - a)/(n - 1); "
+    "    for i to n do "
+    "        t := a + (i - 1)*h; "
+    "        A[1, i, 1] := t; A[1, i, 2] := f(t); "
+    "        A[2, i, 1] := t; A[2, i, 2] := df(t); "
+    "    end do; "
+    "    n "
+    "end proc: "
+    "plot_clip := proc(y) "
+    "    if y > 10 then 10 elif y < -10 then -10 else y end if "
+    "end proc: "
+    "plot_err := proc(ya, ym, yb) "
+    "    local k; "
+    "    k := 0; "
+    "    if abs(ya) < 1e300 then k := k + 1 end if; "
+    "    if abs(ym) < 1e300 then k := k + 1 end if; "
+    "    if abs(yb) < 1e300 then k := k + 1 end if; "
+    "    if k = 0 then return 0 end if; "
+    "    if k < 3 then return 1e300 end if; "
+    "    abs(plot_clip(ym) - (plot_clip(ya) + plot_clip(yb))/2) "
+    "end proc: "
+    "plot_adapt := proc(f, df, a, b, n0, tol, maxdepth, N, A, S) "
+    "    local h, i, m, top, xa, ya, da, xb, yb, db, xm, ym, dm, lev, e; "
+    "    h := (b - a)/(n0 - 1); "
+    "    xa := a; ya := f(xa); da := df(xa); "
+    "    m := 1; "
+    "    A[1, 1, 1] := xa; A[1, 1, 2] := ya; "
+    "    A[2, 1, 1] := xa; A[2, 1, 2] := da; "
+    "    for i to n0 - 1 do "
+    "        xb := a + i*h; "
+    "        top := 1; "
+    "        S[1, 1] := xa; S[1, 2] := ya; S[1, 3] := da; "
+    "        S[1, 4] := xb; S[1, 5] := f(xb); S[1, 6] := df(xb); "
+    "        S[1, 7] := 0; "
+    "        while top > 0 do "
+    "            xa := S[top, 1]; ya := S[top, 2]; da := S[top, 3]; "
+    "            xb := S[top, 4]; yb := S[top, 5]; db := S[top, 6]; "
+    "            lev := S[top, 7]; "
+    "            top := top - 1; "
+    "            if lev < maxdepth and m + top + n0 - i + 1 <= N then "
+    "                xm := (xa + xb)/2; ym := f(xm); dm := df(xm); "
+    "                e := max(plot_err(ya, ym, yb), plot_err(da, dm, db)); "
+    "                if e > tol then "
+    "                    top := top + 1; "
+    "                    S[top, 1] := xm; S[top, 2] := ym; S[top, 3] := dm; "
+    "                    S[top, 4] := xb; S[top, 5] := yb; S[top, 6] := db; "
+    "                    S[top, 7] := lev + 1; "
+    "                    top := top + 1; "
+    "                    S[top, 1] := xa; S[top, 2] := ya; S[top, 3] := da; "
+    "                    S[top, 4] := xm; S[top, 5] := ym; S[top, 6] := dm; "
+    "                    S[top, 7] := lev + 1; "
+    "                    next; "
+    "                end if; "
+    "                m := m + 1; "
+    "                A[1, m, 1] := xm; A[1, m, 2] := ym; "
+    "                A[2, m, 1] := xm; A[2, m, 2] := dm; "
+    "            end if; "
+    "            m := m + 1; "
+    "            A[1, m, 1] := xb; A[1, m, 2] := yb; "
+    "            A[2, m, 1] := xb; A[2, m, 2] := db; "
+    "        end do; "
+    "        xa := xb; ya := yb; da := db; "
+    "    end do; "
+    "    m "
+    "end proc: "
+    "plot_grid := proc(e, a, b, n0, tol, maxdepth, N) "
+    "    local f, df, A, S, m; "
+    "    f := unapply(e, :-x); "
+    "    df := unapply(diff(e, :-x), :-x); "
+    "    A := Array(1..2, 1..N, 1..2, datatype=float[8], order=C_order); "
+    "    S := Array(1..maxdepth + 2, 1..7, datatype=float[8]); "
+    "    try "
+    "        m := evalhf(plot_adapt(f, df, a, b, n0, tol, maxdepth, "
+    "                               N, var(A), var(S))); "
+    "    catch: "
+    "        m := plot_fill(f, df, a, b, N, A); "
+    "    end try; "
+    "    [A, trunc(m)] "
+    "end proc;";
+
+
+static ALGEB grid_proc   = NULL;   /* plot_grid (initMaple) */
+static ALGEB grid_rtable = NULL;   /* dono de func/deriv_points */
+
+/* pontos vivem no Array do Maple: nada de free() */
+static void release_points(void)
+{
+    if (grid_rtable) { MapleGcAllow(kv, grid_rtable); grid_rtable = NULL; }
+    func_points = deriv_points = NULL;
+    num_points = 0;
+    curves_dirty = 1;
+}
+
+/* NaN/inf não são tocados: viram quebras da curva */
+static void clamp_points(double *p, int n)
+{
     for (int i = 0; i < n; ++i) {
-        double x = points[2*i];
-        double y = points[2*i+1];
-        if (isnan(y) || isinf(y)) continue; /* 2ª proteção */
-        glVertex2d(x, y);
+        double y = p[2*i+1];
+        if (!isfinite(y)) continue;      /* ±inf passaria em > 10.0 */
+        if (y > 10.0) y = 10.0;          /* clipping */
+        if (y < -10.0) y = -10.0;
+        p[2*i+1] = y;
     }
-    glEnd();
-    glLineWidth(1.0f);
 }
 
-/* ----------  cálculo com Maple – SAFE  ---------- */
-static void calculate_function_points(const char *f)
+/* ----------  cache LRU de resultados  ---------- */
+/* chave (função, intervalo, orçamento, tolerância); guarda cópias de
+   f, f' e da integral.  Reescolher uma função do menu não chama o
+   Maple.  Cheio: sai a entrada usada há mais tempo. */
+#define PLOT_CACHE_SLOTS 8
+
+typedef struct {
+    const char *function;             /* NULL = livre */
+    double a, b, tol;
+    int budget, n;
+    double *func, *deriv;             /* 2*n doubles cada */
+    int has_integral;
+    double integral;
+    unsigned long used;               /* relógio LRU */
+} PlotCacheEntry;
+
+static PlotCacheEntry plot_cache[PLOT_CACHE_SLOTS];
+static unsigned long plot_cache_clock, plot_cache_hits, plot_cache_misses;
+
+static double now_ms(void)
 {
-    if (!f) return;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/* altura 0 (janela minimizada) vira 1: a tolerância nunca é inf */
+static double current_tol(void)
+{
+    return PLOT_TOL_PX * PLOT_SPAN / (height > 1 ? height : 1);
+}
 
-    /* libera anterior */
-    free(func_points); func_points = NULL;
-    free(deriv_points); deriv_points = NULL;
+static PlotCacheEntry *cache_lookup(const char *f)
+{
+    double tol = current_tol();
+    for (int i = 0; i < PLOT_CACHE_SLOTS; ++i) {
+        PlotCacheEntry *e = &plot_cache[i];
+        if (e->function && !strcmp(e->function, f) && e->a == x_min && e->b == x_max
+            && e->budget == MAX_POINTS && e->tol == tol) {
+            e->used = ++plot_cache_clock;
+            return e;
+        }
+    }
+    return NULL;
+}
 
-    num_points = MAX_POINTS;
-    func_points = calloc(2 * num_points, sizeof(double));
-    deriv_points = calloc(2 * num_points, sizeof(double));
-    if (!func_points || !deriv_points) { perror("calloc"); exit(EXIT_FAILURE); }
+static PlotCacheEntry *cache_store(const char *f)
+{
+    PlotCacheEntry *e = &plot_cache[0];
+    for (int i = 1; i < PLOT_CACHE_SLOTS; ++i)
+        if (plot_cache[i].used < e->used) e = &plot_cache[i];
+
+    size_t bytes = 2 * (size_t)num_points * sizeof(double) + 1;
+    double *func = malloc(bytes), *deriv = malloc(bytes);
+    if (!func || !deriv) { free(func); free(deriv); return NULL; }
+    memcpy(func, func_points, bytes - 1);
+    memcpy(deriv, deriv_points, bytes - 1);
+
+    free(e->func); free(e->deriv);
+    *e = (PlotCacheEntry){ f, x_min, x_max, current_tol(), MAX_POINTS, num_points,
+                           func, deriv, 0, 0.0, ++plot_cache_clock };
+    return e;
+}
 
-    double step = (x_max - x_min) / (num_points - 1);
+static int compute_integral(const char *f, double *out)
+{
     char cmd[512];
+    sprintf(cmd, "evalf(int(%s, x=%.15f..%.15f));", f, x_min, x_max);
+    ALGEB r = EvalMapleStatement(kv, cmd);
+    if (r && !IsMapleNULL(kv, r)) {
+        const char *s = MapleToString(kv, r);
+        if (s && *s) { *out = atof(s); return 1; }
+    }
+    return 0;
+}
 
-    /* ---------- pontos da função ---------- */
-    for (int i = 0; i < num_points; ++i) {
-        double x = x_min + i * step;
-        func_points[2*i] = x;
-        deriv_points[2*i] = x;
-
-        sprintf(cmd, "evalf(subs(x=%.15f, %s));", x, f);
-        ALGEB res = EvalMapleStatement(kv, cmd);
-
-        double y = 0.0;
-        if (res && !IsMapleNULL(kv, res)) {
-            const char *s = MapleToString(kv, res);
-            if (s && *s) {                /* 3ª proteção */
-                y = atof(s);
-                if (isnan(y) || isinf(y)) y = 0.0;
-                if (y > 10.0) y = 10.0;  /* clipping */
-                if (y < -10.0) y = -10.0;
-            }
-        }
-        func_points[2*i+1] = y;
-        deriv_points[2*i+1] = 0.0;
+static void calculate_function_points(const char *f)
+{
+    if (!f) return;
+
+    release_points();                       /* libera anterior */
+
+    /* ---------- cache: sem Maple para f e f' ---------- */
+    double t0 = now_ms();
+    PlotCacheEntry *hit = cache_lookup(f);
+    if (hit) {
+        ++plot_cache_hits;
+        func_points  = hit->func;           /* válidos até o próximo cálculo */
+        deriv_points = hit->deriv;
+        num_points   = hit->n;
+        curves_dirty = 1;
+        if (show_integral && !hit->has_integral)
+            hit->has_integral = compute_integral(f, &hit->integral);
+        if (hit->has_integral) integral_value = hit->integral;
+        printf("cache: %s em %.3f ms (%lu acertos, %lu faltas)\n", f,
+               now_ms() - t0, plot_cache_hits, plot_cache_misses);
+        return;
     }
+    ++plot_cache_misses;
 
-    /* ---------- derivada ---------- */
-    if (show_derivative) {
-        sprintf(cmd, "df := diff(%s, x):", f);
-        EvalMapleStatement(kv, cmd);
+    if (!grid_proc) return;
 
-        for (int i = 0; i < num_points; ++i) {
-            double x = func_points[2*i];
-            sprintf(cmd, "evalf(subs(x=%.15f, df));", x);
-            ALGEB res = EvalMapleStatement(kv, cmd);
-            double dy = 0.0;
-            if (res && !IsMapleNULL(kv, res)) {
-                const char *s = MapleToString(kv, res);
-                if (s && *s) {
-                    dy = atof(s);
-                    if (isnan(dy) || isinf(dy)) dy = 0.0;
-                    if (dy > 10.0) dy = 10.0;
-                    if (dy < -10.0) dy = -10.0;
-                }
-            }
-            deriv_points[2*i+1] = dy;
-        }
+    char cmd[512];
+    sprintf(cmd, "%s;", f);
+    ALGEB expr = EvalMapleStatement(kv, cmd);
+    if (!expr) return;
+
+    /* ---------- função + derivada: uma chamada, adaptativa ---------- */
+    ALGEB res = EvalMapleProc(kv, grid_proc, 7, expr,
+                              ToMapleFloat(kv, x_min),
+                              ToMapleFloat(kv, x_max),
+                              ToMapleInteger(kv, PLOT_COARSE),
+                              ToMapleFloat(kv, current_tol()),
+                              ToMapleInteger(kv, PLOT_MAX_DEPTH),
+                              ToMapleInteger(kv, MAX_POINTS));
+    if (!res || !IsMapleList(kv, res)) {
+        fprintf(stderr, "plot_grid falhou para %s\n", f);
+        return;
     }
+    int n = MapleToInteger32(kv, MapleListSelect(kv, res, 2));
+    res = MapleListSelect(kv, res, 1);
+    MapleGcProtect(kv, res);
+    grid_rtable = res;
+
+    double *data = (double*)RTableDataBlock(kv, res);
+    func_points  = data;
+    deriv_points = data + 2 * MAX_POINTS;  /* f' depois do bloco de f */
+    num_points   = n;
+    clamp_points(func_points, n);
+    clamp_points(deriv_points, n);
+    curves_dirty = 1;
+    PlotCacheEntry *e = cache_store(f);
 
     /* ---------- integral ---------- */
-    if (show_integral) {
-        sprintf(cmd, "evalf(int(%s, x=%.15f..%.15f));", f, x_min, x_max);
-        ALGEB res = EvalMapleStatement(kv, cmd);
-        if (res && !IsMapleNULL(kv, res)) {
-            const char *s = MapleToString(kv, res);
-            if (s && *s) integral_value = atof(s);
+    if (show_integral && compute_integral(f, &integral_value) && e) {
+        e->integral = integral_value;
+        e->has_integral = 1;
+    }
+}
+
+/* sobe os pontos para os VBOs uma vez por cálculo */
+static void upload_curves(void)
+{
+    if (!curves_dirty) return;
+    if (!curve_vbo[0]) glGenBuffers(VBO_COUNT, curve_vbo);
+
+    size_t bytes = 2 * (size_t)num_points * sizeof(double);
+    glBindBuffer(GL_ARRAY_BUFFER, curve_vbo[VBO_FUNC]);
+    glBufferData(GL_ARRAY_BUFFER, bytes, func_points, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, curve_vbo[VBO_DERIV]);
+    glBufferData(GL_ARRAY_BUFFER, bytes, deriv_points, GL_STATIC_DRAW);
+
+    /* faixa (x,0),(x,f(x)) da integral – a grade está toda em [x_min,x_max] */
+    double *area = malloc(2 * bytes + 1);
+    if (area) {
+        for (int i = 0; i < num_points; ++i) {
+            area[4*i+0] = area[4*i+2] = func_points[2*i];
+            area[4*i+1] = 0.0;
+            area[4*i+3] = func_points[2*i+1];
         }
+        glBindBuffer(GL_ARRAY_BUFFER, curve_vbo[VBO_AREA]);
+        glBufferData(GL_ARRAY_BUFFER, 2 * bytes, area, GL_STATIC_DRAW);
+        free(area);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    build_segments(func_points, num_points, &func_segs);
+    build_segments(deriv_points, num_points, &deriv_segs);
+    area_segs.n = func_segs.n;
+    for (int i = 0; i < func_segs.n; ++i) {
+        area_segs.first[i] = 2 * func_segs.first[i];
+        area_segs.count[i] = 2 * func_segs.count[i];
     }
+    curves_dirty = 0;
 }
 
 /* ----------  restante do código (sem mudanças)  ---------- */
@@ -169,23 +426,17 @@ static void renderScene(void)
 {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     drawAxes();
+    upload_curves();
 
-    if (func_points) drawFunction(func_points, num_points, 0.0f, 0.5f, 1.0f, 2.0f);
+    if (func_points) drawFunction(curve_vbo[VBO_FUNC], &func_segs, 0.0f, 0.5f, 1.0f, 2.0f);
     if (show_derivative && deriv_points)
-        drawFunction(deriv_points, num_points, 0.0f, 1.0f, 0.0f, 1.5f);
+        drawFunction(curve_vbo[VBO_DERIV], &deriv_segs, 0.0f, 1.0f, 0.0f, 1.5f);
 
     if (show_integral && func_points) {
         glColor4f(0.0f, 1.0f, 1.0f, 0.2f);
         glEnable(GL_BLEND); glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glBegin(GL_TRIANGLE_STRIP);
-        for (int i = 0; i < num_points; ++i) {
-            double x = func_points[2*i];
-            double y = func_points[2*i+1];
-            if (x < x_min || x > x_max || isnan(y) || isinf(y)) continue;
-            glVertex2d(x, 0.0);
-            glVertex2d(x, y);
-        }
-        glEnd(); glDisable(GL_BLEND);
+        drawBuffer(curve_vbo[VBO_AREA], GL_TRIANGLE_STRIP, &area_segs);
+        glDisable(GL_BLEND);
     }
 
     char buf[256];
@@ -206,7 +457,7 @@ static void renderScene(void)
 
 static void changeSize(int w, int h)
 {
-    if (h == 0) h = 1;
+    if (h <= 0) h = 1;
     width = w; height = h;
     glViewport(0, 0, w, h);
     glMatrixMode(GL_PROJECTION); glLoadIdentity();
@@ -220,24 +471,23 @@ static void processKeys(unsigned char key, int x, int y)
     switch (key) {
     case 'q': case 'Q': exit(0);
     case 'c': case 'C':
-        free(func_points); func_points = NULL;
-        free(deriv_points); deriv_points = NULL;
-        num_points = 0; current_function = NULL;
+        release_points(); current_function = NULL;
         show_integral = show_derivative = 0; break;
     case 'i': case 'I':
         show_integral ^= 1;
         if (show_integral && current_function) calculate_function_points(current_function);
         break;
     case 'd': case 'D':
-        show_derivative ^= 1;
-        if (show_derivative && current_function) calculate_function_points(current_function);
+        show_derivative ^= 1;           /* derivada já vem na grade */
         break;
     }
+    glutPostRedisplay();                /* sem idle: redesenha sob demanda */
 }
 
 static void pickFunction(int opt) {
     current_function = PresetFunctions[opt];
     calculate_function_points(current_function);
+    glutPostRedisplay();
 }
 
 static void initMaple(int argc, char *argv[])
@@ -247,6 +497,10 @@ static void initMaple(int argc, char *argv[])
     kv = StartMaple(argc, argv, &cb, NULL, NULL, err);
     if (!kv) { printf("Maple init erro: %s\n", err); exit(1); }
     printf("✓ Maple inicializado\n");
+
+    grid_proc = EvalMapleStatement(kv, GridProcSource);
+    if (grid_proc && IsMapleProcedure(kv, grid_proc)) MapleGcProtect(kv, grid_proc);
+    else grid_proc = NULL;
 }
 
 int main(int argc, char **argv)
@@ -1,37 +1,105 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 #include <math.h>
 #include "maplec.h"
+#include "../common/libname.h"
 
-/* ---------- protótipo ---------- */
+/* ---------- protótipos ---------- */
 ALGEB M_DECL NewtonsMethod(MKernelVector kv, ALGEB args);
+ALGEB M_DECL NewtonsMethodBatch(MKernelVector kv, ALGEB args);
+ALGEB M_DECL NewtonsCacheStats(MKernelVector kv, ALGEB args);
 
-/* ---------- implementação ---------- */
-ALGEB M_DECL NewtonsMethod(MKernelVector kv, ALGEB args)
+/* ---------- cache de f e f' ---------- */
+/* O Maple mantém as expressões simplificadas únicas (tabela de
+   simplificação): a mesma expressão é sempre o mesmo ALGEB. O ponteiro
+   serve de chave; chave, f e f' ficam protegidos com MapleGcProtect
+   enquanto estiverem no cache, então o endereço não é reaproveitado. */
+#define NEWTON_CACHE_SIZE  64   /* potência de 2 */
+#define NEWTON_CACHE_PROBE 8
+
+typedef struct {
+    ALGEB key;      /* expressão/procedure recebida (NULL = livre) */
+    ALGEB f;        /* procedure de f */
+    ALGEB fprime;   /* procedure de f' */
+} NewtonCacheEntry;
+
+static NewtonCacheEntry newton_cache[NEWTON_CACHE_SIZE];
+static unsigned long newton_cache_hits = 0;
+static unsigned long newton_cache_misses = 0;
+
+static size_t newton_cache_slot(ALGEB key)
 {
-    if (MapleNumArgs(kv, args) != 3) {
-        MapleRaiseError(kv, "three arguments expected");
-        return NULL;
+    uintptr_t h = (uintptr_t)key >> 4;
+    h *= (uintptr_t)0x9E3779B97F4A7C15ull;
+    return (size_t)(h >> 20) & (NEWTON_CACHE_SIZE - 1);
+}
+
+static NewtonCacheEntry *newton_cache_find(ALGEB key)
+{
+    size_t home = newton_cache_slot(key);
+    for (size_t i = 0; i < NEWTON_CACHE_PROBE; ++i) {
+        NewtonCacheEntry *e =
+            &newton_cache[(home + i) & (NEWTON_CACHE_SIZE - 1)];
+        if (e->key == key) return e;
+        if (!e->key) return NULL;
     }
-    M_INT idx1 = 1, idx2 = 2, idx3 = 3;
-    ALGEB f_arg  = MapleSelectIndexed(kv, args, 1, &idx1);
-    ALGEB x0_arg = MapleSelectIndexed(kv, args, 1, &idx2);
-    ALGEB tol_arg= MapleSelectIndexed(kv, args, 1, &idx3);
+    return NULL;
+}
+
+static void newton_cache_insert(MKernelVector kv, ALGEB key,
+                                ALGEB f, ALGEB fprime)
+{
+    size_t home = newton_cache_slot(key);
+    NewtonCacheEntry *e = &newton_cache[home];   /* vítima se cheio */
+    for (size_t i = 0; i < NEWTON_CACHE_PROBE; ++i) {
+        NewtonCacheEntry *c =
+            &newton_cache[(home + i) & (NEWTON_CACHE_SIZE - 1)];
+        if (!c->key) { e = c; break; }
+    }
+    if (e->key) {
+        MapleGcAllow(kv, e->key);
+        MapleGcAllow(kv, e->f);
+        MapleGcAllow(kv, e->fprime);
+    }
+    MapleGcProtect(kv, key);
+    MapleGcProtect(kv, f);
+    MapleGcProtect(kv, fprime);
+    e->key = key;
+    e->f = f;
+    e->fprime = fprime;
+}
+
+/* ---------- f e f' como procedures ---------- */
+/* Converte f (expressão ou procedure) para procedure e monta f' com
+   unapply(diff(...)).  Devolve 0 (e levanta erro no Maple) se falhar.
+   Resultados ficam no cache: repetir a mesma f não deriva de novo. */
+static int MakeNewtonProcs(MKernelVector kv, ALGEB f_arg,
+                           ALGEB *f_out, ALGEB *fprime_out)
+{
+    NewtonCacheEntry *hit = newton_cache_find(f_arg);
+    if (hit) {
+        ++newton_cache_hits;
+        *f_out = hit->f;
+        *fprime_out = hit->fprime;
+        return 1;
+    }
+    ++newton_cache_misses;
 
-    /* converte função para procedure se necessário */
     ALGEB f = f_arg;
     if (!IsMapleProcedure(kv, f)) {
         ALGEB indets = EvalMapleProc(kv, ToMapleName(kv, "indets", TRUE), 1, f);
         if (!IsMapleSet(kv, indets) || MapleNumArgs(kv, indets) != 1) {
             MapleRaiseError(kv, "cannot find indeterminate");
-            return NULL;
+            return 0;
         }
         M_INT one = 1;
         ALGEB xvar = MapleSelectIndexed(kv, indets, 1, &one);
         f = EvalMapleProc(kv, ToMapleName(kv, "unapply", TRUE), 2, f, xvar);
         if (!f || !IsMapleProcedure(kv, f)) {
             MapleRaiseError(kv, "cannot convert to procedure");
-            return NULL;
+            return 0;
         }
     }
 
@@ -42,8 +110,39 @@ ALGEB M_DECL NewtonsMethod(MKernelVector kv, ALGEB args)
                                  xsym);
     if (!fprime || !IsMapleProcedure(kv, fprime)) {
         MapleRaiseError(kv, "cannot compute derivative");
+        return 0;
+    }
+    newton_cache_insert(kv, f_arg, f, fprime);
+    *f_out = f;
+    *fprime_out = fprime;
+    return 1;
+}
+
+/* [acertos, faltas] do cache de f/f' */
+ALGEB M_DECL NewtonsCacheStats(MKernelVector kv, ALGEB args)
+{
+    (void)args;
+    ALGEB list = MapleListAlloc(kv, 2);
+    MapleListAssign(kv, list, 1, ToMapleInteger(kv, (M_INT)newton_cache_hits));
+    MapleListAssign(kv, list, 2, ToMapleInteger(kv, (M_INT)newton_cache_misses));
+    return list;
+}
+
+/* ---------- implementação ---------- */
+ALGEB M_DECL NewtonsMethod(MKernelVector kv, ALGEB args)
+{
+    if (MapleNumArgs(kv, args) != 3) {
+        MapleRaiseError(kv, "three arguments expected");
         return NULL;
     }
+    M_INT idx1 = 1, idx2 = 2, idx3 = 3;
+    ALGEB f_arg  = MapleSelectIndexed(kv, args, 1, &idx1);
+    ALGEB x0_arg = MapleSelectIndexed(kv, args, 1, &idx2);
+    ALGEB tol_arg= MapleSelectIndexed(kv, args, 1, &idx3);
+
+    ALGEB f, fprime;
+    if (!MakeNewtonProcs(kv, f_arg, &f, &fprime))
+        return NULL;
 
     double guess = MapleEvalhf(kv, x0_arg);
     double tol   = MapleEvalhf(kv, tol_arg);
@@ -61,14 +160,157 @@ ALGEB M_DECL NewtonsMethod(MKernelVector kv, ALGEB args)
     return ToMapleFloat(kv, guess);
 }
 
+/* ---------- Newton em lote (multi-start) ---------- */
+/* Todas as sementes iteram dentro de UMA chamada evalhf: o laço de
+   Newton roda no avaliador de hardware floats do Maple, com f e f'
+   já montadas, sem ida e volta ao C por iteração. */
+static const char *NewtonBatchSource =
+    "proc(f, fp, X, n, tol, maxit, R, IT, OK) "
+    "    local i, k, x, fx, fpx; "
+    "    for i to n do "
+    "        x := X[i]; OK[i] := 0; "
+    "        for k to maxit do "
+    "            fx := f(x); "
+    "            if abs(fx) <= tol then OK[i] := 1; break end if; "
+    "            fpx := fp(x); "
+    "            if fpx = 0 then break end if; "
+    "            x := x - fx/fpx; "
+    "        end do; "
+    "        R[i] := x; IT[i] := min(k, maxit); "
+    "    end do; "
+    "    0 "
+    "end proc:";
+
+#define NEWTON_MAXIT 500
+
+/* Vector float[8] alocado pelo Maple; o C escreve/lê no bloco */
+static ALGEB NewFloatVector(MKernelVector kv, M_INT n)
+{
+    RTableSettings rts;
+    M_INT bounds[2] = { 1, n };
+    RTableGetDefaults(kv, &rts);
+    rts.data_type = RTABLE_FLOAT64;
+    rts.num_dimensions = 1;
+    rts.subtype = RTABLE_COLUMN;
+    return RTableCreate(kv, &rts, NULL, bounds);
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* desfaz o MapleGcProtect dos vetores de saída (U pode ser NULL) */
+static void ReleaseOutputs(MKernelVector kv, ALGEB R, ALGEB IT, ALGEB OK,
+                           ALGEB U)
+{
+    MapleGcAllow(kv, R);
+    MapleGcAllow(kv, IT);
+    MapleGcAllow(kv, OK);
+    if (U)
+        MapleGcAllow(kv, U);
+}
+
+/* args = [f, X0, tol], X0 um Vector float[8] de sementes.
+   Devolve [R, IT, OK, U]: raízes, iterações, convergiu (1/0) e as
+   raízes distintas (deduplicadas com tolerância tol). */
+ALGEB M_DECL NewtonsMethodBatch(MKernelVector kv, ALGEB args)
+{
+    static ALGEB kernel = NULL, run = NULL;
+
+    if (MapleNumArgs(kv, args) != 3) {
+        MapleRaiseError(kv, "three arguments expected");
+        return NULL;
+    }
+    M_INT idx1 = 1, idx2 = 2, idx3 = 3;
+    ALGEB f_arg   = MapleSelectIndexed(kv, args, 1, &idx1);
+    ALGEB seeds   = MapleSelectIndexed(kv, args, 1, &idx2);
+    ALGEB tol_arg = MapleSelectIndexed(kv, args, 1, &idx3);
+
+    if (!IsMapleRTable(kv, seeds)) {
+        MapleRaiseError(kv, "seeds must be a float[8] Vector");
+        return NULL;
+    }
+    ALGEB f, fprime;
+    if (!MakeNewtonProcs(kv, f_arg, &f, &fprime))
+        return NULL;
+
+    if (!kernel) {
+        kernel = EvalMapleStatement(kv, NewtonBatchSource);
+        run = EvalMapleStatement(kv,
+            "proc(K, f, fp, X, n, tol, maxit, R, IT, OK) "
+            "    evalhf(K(f, fp, X, n, tol, maxit, var(R), var(IT), var(OK))) "
+            "end proc:");
+        if (!kernel || !run) {
+            kernel = NULL;
+            return NULL;
+        }
+        MapleGcProtect(kv, kernel);
+        MapleGcProtect(kv, run);
+    }
+
+    M_INT n = RTableNumElements(kv, seeds);
+    double tol = MapleEvalhf(kv, tol_arg);
+
+    /* vetores de saída do Maple; o C lê os blocos direto. Ficam
+       protegidos até o último MapleListAssign: NewFloatVector e
+       MapleListAlloc abaixo podem disparar o GC */
+    ALGEB R  = NewFloatVector(kv, n);
+    MapleGcProtect(kv, R);
+    ALGEB IT = NewFloatVector(kv, n);
+    MapleGcProtect(kv, IT);
+    ALGEB OK = NewFloatVector(kv, n);
+    MapleGcProtect(kv, OK);
+    ALGEB st = EvalMapleProc(kv, run, 10, kernel, f, fprime, seeds,
+                             ToMapleInteger(kv, n), ToMapleFloat(kv, tol),
+                             ToMapleInteger(kv, NEWTON_MAXIT), R, IT, OK);
+    if (!st) {
+        ReleaseOutputs(kv, R, IT, OK, NULL);
+        return NULL;
+    }
+
+    /* deduplica as raízes convergidas: ordena e funde vizinhas */
+    double *r  = (double *)RTableDataBlock(kv, R);
+    double *ok = (double *)RTableDataBlock(kv, OK);
+    double *u  = malloc((n > 0 ? n : 1) * sizeof(double));
+    M_INT nu = 0, i;
+    if (!u) {
+        ReleaseOutputs(kv, R, IT, OK, NULL);
+        MapleRaiseError(kv, "out of memory");
+        return NULL;
+    }
+    for (i = 0; i < n; ++i)
+        if (ok[i] != 0.0) u[nu++] = r[i];
+    qsort(u, nu, sizeof(double), cmp_double);
+
+    M_INT nd = 0;
+    for (i = 0; i < nu; ++i)
+        if (nd == 0 || fabs(u[i] - u[nd - 1]) > tol * fmax(1.0, fabs(u[i])))
+            u[nd++] = u[i];
+
+    ALGEB U = NewFloatVector(kv, nd);
+    MapleGcProtect(kv, U);
+    double *ud = (double *)RTableDataBlock(kv, U);
+    for (i = 0; i < nd; ++i) ud[i] = u[i];
+    free(u);
+
+    ALGEB list = MapleListAlloc(kv, 4);
+    MapleListAssign(kv, list, 1, R);
+    MapleListAssign(kv, list, 2, IT);
+    MapleListAssign(kv, list, 3, OK);
+    MapleListAssign(kv, list, 4, U);
+    ReleaseOutputs(kv, R, IT, OK, U);
+    return list;
+}
+
 /* ---------- cria lista sem parser ---------- */
 static ALGEB MakeList3(MKernelVector kv, ALGEB a, ALGEB b, ALGEB c)
 {
-    ALGEB list = MapleNewList(kv, 3);
-    M_INT i1 = 1, i2 = 2, i3 = 3;
-    MapleListAssign(kv, list, 1, &i1, a);
-    MapleListAssign(kv, list, 1, &i2, b);
-    MapleListAssign(kv, list, 1, &i3, c);
+    ALGEB list = MapleListAlloc(kv, 3);
+    MapleListAssign(kv, list, 1, a);
+    MapleListAssign(kv, list, 2, b);
+    MapleListAssign(kv, list, 3, c);
     return list;
 }
 
@@ -78,19 +320,17 @@ int main(int argc, char *argv[])
     char err[2048];
     MCallBackVectorDesc cb = { 0 };
 
-    /* 1. garante libname antes de qualquer coisa */
-    if (getenv("MAPLE"))
-        sprintf(err, "libname := \"%s/lib\":", getenv("MAPLE"));
-    else
-        strcpy(err, "libname := \"/opt/maple2021/lib\":"); /* fallback */
-    EvalMapleStatement(NULL, err); /* NULL = ainda sem kv, mas já define libname */
-
     MKernelVector kv = StartMaple(argc, argv, &cb, NULL, NULL, err);
     if (!kv) {
         printf("Erro ao iniciar Maple: %s\n", err);
         return 1;
     }
 
+    /* 1. libname logo após o StartMaple: EvalMapleStatement precisa
+     * de um kv válido (com NULL não há kernel para avaliar nada).
+     * $MAPLE, $MAPLE_ROOT ou /opt/maple*, via common/libname.h */
+    maple_libname_apply(kv);
+
     /* 2. constrói lista [x^4-1, 2.0, 0.001] */
     ALGEB f_expr = EvalMapleStatement(kv, "x^4 - 1");
     ALGEB list = MakeList3(kv, f_expr,
@@ -103,5 +343,51 @@ int main(int argc, char *argv[])
     else
         printf("Falhou.\n");
 
+    /* 3. multi-start: grade densa de sementes em [-2, 2] */
+    enum { NSEEDS = 2000 };
+    static double seeds[NSEEDS];
+    for (int i = 0; i < NSEEDS; ++i)
+        seeds[i] = -2.0 + 4.0 * i / (NSEEDS - 1);
+
+    /* Vector foreign: o Maple lê as sementes direto da memória C */
+    RTableSettings rts;
+    M_INT bounds[2] = { 1, NSEEDS };
+    RTableGetDefaults(kv, &rts);
+    rts.data_type = RTABLE_FLOAT64;
+    rts.num_dimensions = 1;
+    rts.foreign = 1;
+    rts.subtype = RTABLE_COLUMN;
+    ALGEB X0 = RTableCreate(kv, &rts, seeds, bounds);
+
+    ALGEB batch = NewtonsMethodBatch(kv, MakeList3(kv, f_expr, X0,
+                                                   ToMapleFloat(kv, 1e-10)));
+    if (batch) {
+        M_INT i4 = 4, i2 = 2, i3 = 3;
+        ALGEB U  = MapleSelectIndexed(kv, batch, 1, &i4);
+        double *it = (double *)RTableDataBlock(kv, MapleSelectIndexed(kv, batch, 1, &i2));
+        double *ok = (double *)RTableDataBlock(kv, MapleSelectIndexed(kv, batch, 1, &i3));
+        long conv = 0;
+        double iters = 0.0;
+        for (int i = 0; i < NSEEDS; ++i) {
+            conv += ok[i] != 0.0;
+            iters += it[i];
+        }
+        printf("%d sementes: %ld convergiram, %.1f iterações em média\n",
+               NSEEDS, conv, iters / NSEEDS);
+        MapleALGEB_Printf(kv, "Raízes distintas: %a\n", U);
+    }
+    else
+        printf("Lote falhou.\n");
+
+    /* 4. mesma f, vários x0: só a primeira chamada deriva */
+    for (int i = 0; i < 100; ++i) {
+        ALGEB args = MakeList3(kv, f_expr,
+                               ToMapleFloat(kv, 0.5 + 0.025 * i),
+                               ToMapleFloat(kv, 1e-10));
+        NewtonsMethod(kv, args);
+    }
+    MapleALGEB_Printf(kv, "Cache f/f' [acertos, faltas]: %a\n",
+                      NewtonsCacheStats(kv, NULL));
+
     return 0;
 }
@@ -0,0 +1,80 @@
+/* capture.cpp - writeto em arquivo x captura em memória
+ *
+ * Exporta N randpoly e o lprint de uma Matrix 200 x 200 de duas
+ * formas e mede o tempo até o texto estar numa std::string:
+ *   1. writeto("capture.out") + leitura do arquivo (como no 19-ex)
+ *   2. maple.capture("dump"): writeto("dump") vai para memória
+ * A segunda captura usa um limite de spill pequeno para mostrar a
+ * passagem para o arquivo mapeado.
+ *
+ * ./capture [N]   (padrão: 2000)
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "maple_kernel.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0)
+        .count();
+}
+
+int main(int argc, char* argv[])
+{
+    const int         N    = argc > 1 ? std::atoi(argv[1]) : 2000;
+    const std::string dump = "for i to " + std::to_string(N)
+                             + " do lprint(randpoly([x, y, z],"
+                               " degree = 8, terms = 30)) end do:"
+                               " lprint(Matrix(200, 200, (i,j) -> i/j)):";
+
+    try
+    {
+        MapleKernel maple{1, argv};
+        maple.executeCommand("interface(rtablesize = infinity):");
+
+        // --- 1. arquivo de verdade ---
+        auto t0 = Clock::now();
+        maple.executeCommand("writeto(\"capture.out\"): " + dump
+                             + " writeto(terminal):");
+        std::ifstream     f("capture.out");
+        std::stringstream ss;
+        ss << f.rdbuf();
+        std::string from_file = ss.str();
+        double      ms_file   = msSince(t0);
+
+        // --- 2. captura em memória ---
+        auto buf = maple.capture("dump", size_t{4} << 20);
+        t0       = Clock::now();
+        maple.executeCommand("writeto(\"dump\"): " + dump
+                             + " writeto(terminal):");
+        std::string_view from_mem = buf->view();
+        double           ms_mem   = msSince(t0);
+
+        std::cout << "\n=== " << N << " randpoly + Matrix 200 x 200 ===\n";
+        std::cout << "writeto arquivo + leitura: " << ms_file << " ms ("
+                  << from_file.size() << " bytes)\n";
+        std::cout << "capture em memória:        " << ms_mem << " ms ("
+                  << from_mem.size() << " bytes"
+                  << (buf->spilled() ? ", spill em mmap" : "") << ")\n";
+
+        // appendto acrescenta ao mesmo buffer
+        maple.executeCommand(
+            "appendto(\"dump\"): lprint(evalf(Pi, 30)): "
+            "writeto(terminal):");
+        std::cout << "depois do appendto: " << buf->size()
+                  << " bytes\n";
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "\nFATAL EXCEPTION: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
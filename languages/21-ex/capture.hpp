@@ -0,0 +1,300 @@
+/* capture.hpp - writeto/appendto para buffers em memória
+ *
+ * No 19-ex/redirectCallBack.c o redirectCallBack abre arquivos de
+ * verdade a cada writeto/appendto. Com o RedirectTable, os destinos
+ * registrados em MapleKernel::capture() (ou todos, com
+ * captureAll(true)) viram CaptureBuffers em memória: exportar um
+ * randpoly gigante ou o lprint de uma Matrix grande não passa pelo
+ * disco. writeto limpa o buffer, appendto acrescenta.
+ *
+ * Acima de `spillThreshold` bytes o buffer passa para um arquivo
+ * temporário mapeado com mmap (MAP_SHARED): a escrita continua sendo
+ * um memcpy, mas as páginas podem ir para o disco em vez de pesar na
+ * memória anônima do processo.
+ *
+ * Destinos não capturados continuam indo para arquivos, como no
+ * 19-ex; "terminal"/"default" voltam ao textCallBack normal.
+ *
+ * RedirectTable::write roda dentro do textCallBack, um callback C
+ * do OpenMaple: nenhuma exceção pode sair dali. Se o tmpfile falhar,
+ * o buffer fica em memória; se o ftruncate/mmap de um buffer já
+ * mapeado falhar, a linha é descartada e contada em dropped().
+ */
+
+#ifndef CAPTURE_HPP
+#define CAPTURE_HPP
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// ===========================================
+// CAPTUREBUFFER
+// ===========================================
+
+class CaptureBuffer
+{
+  public:
+    explicit CaptureBuffer(size_t spillThreshold = size_t{64} << 20)
+        : threshold(spillThreshold)
+    {
+    }
+
+    ~CaptureBuffer()
+    {
+        unmap();
+    }
+
+    CaptureBuffer(const CaptureBuffer&)            = delete;
+    CaptureBuffer& operator=(const CaptureBuffer&) = delete;
+
+    void append(std::string_view s)
+    {
+        if(file == nullptr && mem.size() + s.size() > threshold)
+            spill(mem.size() + s.size());
+
+        if(file == nullptr)
+        {
+            mem.append(s);
+            return;
+        }
+        if(length + s.size() > capacity)
+            grow(length + s.size());
+        std::memcpy(map + length, s.data(), s.size());
+        length += s.size();
+    }
+
+    void clear()
+    {
+        mem.clear();
+        length = 0;
+    }
+
+    // Válido até o próximo append/clear
+    std::string_view view() const
+    {
+        return file == nullptr ? std::string_view(mem)
+                               : std::string_view(map, length);
+    }
+
+    std::string str() const
+    {
+        return std::string(view());
+    }
+
+    size_t size() const
+    {
+        return file == nullptr ? mem.size() : length;
+    }
+
+    // true depois que passou do limite e foi para o mmap
+    bool spilled() const
+    {
+        return file != nullptr;
+    }
+
+    // Linhas descartadas por falha de ftruncate/mmap, e o último erro
+    size_t dropped() const
+    {
+        return droppedLines;
+    }
+
+    const char* error() const
+    {
+        return lastError;
+    }
+
+    // Chamado pelo RedirectTable quando append() falhou
+    void drop(const char* why) noexcept
+    {
+        ++droppedLines;
+        std::snprintf(lastError, sizeof lastError, "%s", why);
+    }
+
+  private:
+    size_t      threshold;
+    std::string mem;
+
+    std::FILE* file     = nullptr;
+    char*      map      = nullptr;
+    size_t     length   = 0;
+    size_t     capacity = 0;
+
+    size_t droppedLines  = 0;
+    char   lastError[96] = "";
+
+    // Sem arquivo temporário o buffer continua em memória (não tenta
+    // de novo a cada linha)
+    void spill(size_t need)
+    {
+        file = std::tmpfile();
+        try
+        {
+            if(file == nullptr)
+                throw std::runtime_error("capture: tmpfile falhou");
+            grow(need);
+        }
+        catch(const std::exception& e)
+        {
+            // a linha não se perde: só registra o erro
+            std::snprintf(lastError, sizeof lastError, "%s", e.what());
+            unmap();
+            threshold = static_cast<size_t>(-1);
+            return;
+        }
+        std::memcpy(map, mem.data(), mem.size());
+        length = mem.size();
+        std::string().swap(mem);
+    }
+
+    // dobra o arquivo e o mapeamento até caber `need` bytes; começa
+    // em pelo menos uma página (threshold 0 faz spill já na 1ª escrita).
+    // O mapeamento antigo só sai depois que o novo existe: se algo
+    // falhar, o buffer continua como estava.
+    void grow(size_t need)
+    {
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t cap  = capacity;
+        if(cap == 0)
+            cap = std::max({threshold, need, page});
+        while(cap < need)
+            cap *= 2;
+
+        if(ftruncate(fileno(file), static_cast<off_t>(cap)) != 0)
+            throw std::runtime_error("capture: ftruncate falhou");
+        void* p = mmap(nullptr,
+                       cap,
+                       PROT_READ | PROT_WRITE,
+                       MAP_SHARED,
+                       fileno(file),
+                       0);
+        if(p == MAP_FAILED)
+            throw std::runtime_error("capture: mmap falhou");
+        if(map != nullptr)
+            munmap(map, capacity);
+        map      = static_cast<char*>(p);
+        capacity = cap;
+    }
+
+    void unmap()
+    {
+        if(map != nullptr)
+            munmap(map, capacity);
+        if(file != nullptr)
+            std::fclose(file);
+        map      = nullptr;
+        file     = nullptr;
+        length   = 0;
+        capacity = 0;
+    }
+};
+
+// ===========================================
+// REDIRECTTABLE
+// ===========================================
+
+class RedirectTable
+{
+  public:
+    ~RedirectTable()
+    {
+        closeFile();
+    }
+
+    std::shared_ptr<CaptureBuffer> add(const std::string& name,
+                                       size_t spillThreshold)
+    {
+        auto& buf = buffers[name];
+        if(!buf)
+            buf = std::make_shared<CaptureBuffer>(spillThreshold);
+        return buf;
+    }
+
+    std::shared_ptr<CaptureBuffer> find(const std::string& name) const
+    {
+        auto it = buffers.find(name);
+        return it == buffers.end() ? nullptr : it->second;
+    }
+
+    void setCaptureAll(bool on)
+    {
+        captureAll = on;
+    }
+
+    // true enquanto um writeto/appendto está ativo
+    bool active() const
+    {
+        return current != nullptr || file != nullptr;
+    }
+
+    // Uma linha do textCallBack; não lança (ver o topo do arquivo)
+    void write(const char* output) noexcept
+    {
+        if(current != nullptr)
+        {
+            try
+            {
+                current->append(output);
+                current->append("\n");
+            }
+            catch(const std::exception& e)
+            {
+                current->drop(e.what());
+            }
+            catch(...)
+            {
+                current->drop("capture: erro desconhecido");
+            }
+        }
+        else if(file != nullptr)
+        {
+            std::fprintf(file, "%s\n", output);
+        }
+    }
+
+    // redirectCallBack: name == nullptr ou "terminal"/"default"
+    // volta ao normal; mode "w" (writeto) ou "a" (appendto)
+    bool redirect(const char* name, const char* mode)
+    {
+        current = nullptr;
+        closeFile();
+        if(name == nullptr || std::strcmp(name, "default") == 0
+           || std::strcmp(name, "terminal") == 0)
+            return true;
+
+        auto buf = captureAll ? add(name, size_t{64} << 20) : find(name);
+        if(buf)
+        {
+            if(mode == nullptr || mode[0] != 'a')
+                buf->clear();
+            current = buf.get();
+            return true;
+        }
+
+        file = std::fopen(name, mode != nullptr ? mode : "w");
+        return file != nullptr;
+    }
+
+  private:
+    std::map<std::string, std::shared_ptr<CaptureBuffer>> buffers;
+
+    bool           captureAll = false;
+    CaptureBuffer* current    = nullptr;
+    std::FILE*     file       = nullptr;
+
+    void closeFile()
+    {
+        if(file != nullptr)
+            std::fclose(file);
+        file = nullptr;
+    }
+};
+
+#endif /* CAPTURE_HPP */
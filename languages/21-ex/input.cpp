@@ -0,0 +1,75 @@
+/* input.cpp - readline() e stopat sem terminal (InputFeeder)
+ *
+ * Roda o roteiro do 19-ex/readLineCallBack.c (readline() + stopat)
+ * N vezes sem ninguém no teclado: as respostas vêm de um arquivo
+ * mapeado (gerado aqui) e os prompts do depurador recebem "cont".
+ *
+ * ./input [N]   (padrão: 1000)
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "maple_kernel.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0)
+        .count();
+}
+
+int main(int argc, char* argv[])
+{
+    const int N = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+    // uma resposta por readline(), como se alguém digitasse
+    {
+        std::ofstream f("input.txt");
+        for(int i = 0; i < N; ++i)
+            f << (i % 10) + 1 << "\n";
+    }
+
+    try
+    {
+        MapleKernel  maple{1, argv};
+        InputFeeder& in = maple.input();
+        in.pushLines("5");  // a fila é servida antes do arquivo
+        in.loadFile("input.txt");
+        in.setDebugPolicy(InputFeeder::DebugPolicy::Continue);
+
+        maple.executeCommand("hits := 0:");
+        auto t0 = Clock::now();
+        maple.executeCommand(
+            "to " + std::to_string(N + 1)
+            + " do num := parse(readline()); "
+              "if num = rand() mod 10 then hits := hits + 1 end if "
+              "end do:");
+        double ms_read = msSince(t0);
+
+        maple.executeCommand("stopat(int):");
+        t0 = Clock::now();
+        maple.executeCommand("to 20 do int(1/(x^4+1), x) end do:");
+        double ms_debug = msSince(t0);
+        maple.executeCommand("unstopat(int):");
+
+        auto st = in.stats();
+        std::cout << "\n=== " << N + 1 << " readline() roteirizados ===\n";
+        std::cout << "readline: " << ms_read << " ms, acertos "
+                  << maple.toString(maple.executeCommand("hits;"))
+                  << "\n";
+        std::cout << "stopat(int) x 20: " << ms_debug << " ms\n";
+        std::cout << st.lines << " linhas, " << st.debugPrompts
+                  << " prompts do depurador, " << st.starved
+                  << " sem entrada\n";
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "\nFATAL EXCEPTION: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,203 @@
+/* input_feeder.hpp - Respostas roteirizadas para o readLineCallBack
+ *
+ * No 19-ex/readLineCallBack.c cada readline() e cada prompt do
+ * depurador (stopat) param esperando o terminal. Em lote isso trava
+ * o job. O InputFeeder responde sem I/O de terminal:
+ *
+ *   - de uma fila pré-carregada (push/pushLines), O(1) por pedido;
+ *   - de um arquivo de entrada mapeado com mmap (loadFile), uma
+ *     linha por pedido a partir de um cursor, sem reler o arquivo;
+ *   - nos prompts do depurador, segundo a política escolhida:
+ *       Continue   responde "cont" (padrão)
+ *       Quit       responde "quit" (abandona a depuração)
+ *       Script     usa a próxima linha do roteiro
+ *     Depois de maxDebugPrompts prompts na mesma avaliação a
+ *     resposta vira "quit", para que um stopat num laço não prenda
+ *     o worker para sempre. O MapleKernel zera essa contagem a cada
+ *     executeCommand de fora (beginEvaluation).
+ *
+ * A fila é servida antes do arquivo. Sem entrada disponível a
+ * resposta é uma linha vazia (contada em stats().starved).
+ */
+
+#ifndef INPUT_FEEDER_HPP
+#define INPUT_FEEDER_HPP
+
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+class InputFeeder
+{
+  public:
+    enum class DebugPolicy
+    {
+        Continue,
+        Quit,
+        Script
+    };
+
+    struct Stats
+    {
+        uint64_t lines;         // readline() atendidos com roteiro
+        uint64_t debugPrompts;  // prompts do depurador
+        uint64_t starved;       // pedidos sem entrada disponível
+    };
+
+    InputFeeder() = default;
+
+    ~InputFeeder()
+    {
+        unmap();
+    }
+
+    InputFeeder(const InputFeeder&)            = delete;
+    InputFeeder& operator=(const InputFeeder&) = delete;
+
+    void push(std::string line)
+    {
+        queue.push_back(std::move(line));
+    }
+
+    // Uma entrada por linha de `text`
+    void pushLines(std::string_view text)
+    {
+        while(!text.empty())
+        {
+            size_t nl = text.find('\n');
+            push(std::string(text.substr(0, nl)));
+            text.remove_prefix(nl == text.npos ? text.size() : nl + 1);
+        }
+    }
+
+    // Mapeia `path` e serve suas linhas depois da fila
+    void loadFile(const std::string& path)
+    {
+        unmap();
+        int fd = open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+            throw std::runtime_error("input: não abriu " + path);
+        struct stat st;
+        if(fstat(fd, &st) != 0)
+        {
+            close(fd);
+            throw std::runtime_error("input: fstat " + path);
+        }
+        size_t len = static_cast<size_t>(st.st_size);
+        if(len > 0)
+        {
+            void* p
+                = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(p == MAP_FAILED)
+            {
+                close(fd);
+                throw std::runtime_error("input: mmap " + path);
+            }
+            madvise(p, len, MADV_SEQUENTIAL);
+            mapBase = static_cast<const char*>(p);
+            mapLen  = len;
+            file    = {mapBase, len};
+        }
+        close(fd);
+    }
+
+    void setDebugPolicy(DebugPolicy p, uint64_t maxPrompts = 10000)
+    {
+        debugPolicy     = p;
+        maxDebugPrompts = maxPrompts;
+    }
+
+    // true enquanto há linhas na fila ou no arquivo
+    bool pending() const
+    {
+        return !queue.empty() || !file.empty();
+    }
+
+    Stats stats() const
+    {
+        return {lines, debugPrompts, starved};
+    }
+
+    void resetStats()
+    {
+        lines = debugPrompts = starved = 0;
+    }
+
+    // Nova avaliação: o limite de prompts do depurador recomeça
+    void beginEvaluation()
+    {
+        sessionPrompts = 0;
+    }
+
+    // Chamado pelo readLineCallBack; o ponteiro vale até a próxima
+    // chamada
+    char* next(bool debug)
+    {
+        if(debug)
+        {
+            ++debugPrompts;
+            if(++sessionPrompts > maxDebugPrompts
+               || debugPolicy == DebugPolicy::Quit)
+                return answer("quit");
+            if(debugPolicy == DebugPolicy::Continue)
+                return answer("cont");
+        }
+
+        if(!queue.empty())
+        {
+            reply = std::move(queue.front());
+            queue.pop_front();
+            ++lines;
+            return &reply[0];
+        }
+        if(!file.empty())
+        {
+            size_t nl = file.find('\n');
+            reply.assign(file.substr(0, nl));
+            file.remove_prefix(nl == file.npos ? file.size() : nl + 1);
+            ++lines;
+            return &reply[0];
+        }
+
+        ++starved;
+        return answer(debug ? "quit" : "");
+    }
+
+  private:
+    std::deque<std::string> queue;
+    std::string_view        file;     // o que falta servir do mmap
+    const char*             mapBase = nullptr;
+    size_t                  mapLen  = 0;
+    std::string             reply;
+
+    DebugPolicy debugPolicy     = DebugPolicy::Continue;
+    uint64_t    maxDebugPrompts = 10000;
+
+    uint64_t lines          = 0;
+    uint64_t debugPrompts   = 0;
+    uint64_t starved        = 0;
+    uint64_t sessionPrompts = 0;  // prompts desde beginEvaluation()
+
+    char* answer(const char* s)
+    {
+        reply = s;
+        return &reply[0];
+    }
+
+    void unmap()
+    {
+        if(mapBase != nullptr)
+            munmap(const_cast<char*>(mapBase), mapLen);
+        mapBase = nullptr;
+        mapLen  = 0;
+        file    = {};
+    }
+};
+
+#endif /* INPUT_FEEDER_HPP */
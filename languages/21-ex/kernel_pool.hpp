@@ -0,0 +1,393 @@
+/* kernel_pool.hpp - Pool de processos com kernels Maple "quentes"
+ *
+ * O OpenMaple só permite um kernel por processo. Para usar mais de
+ * um núcleo (e não pagar StartMaple + libname + with(...) a cada
+ * job), o pool cria N processos filhos com fork(). Cada filho sobe
+ * seu MapleKernel uma única vez, pré-carrega os pacotes e fica
+ * esperando jobs num socket Unix (socketpair).
+ *
+ * Protocolo (frames: tipo[1] + tamanho[4] + bytes):
+ *   pai -> filho  'J' comando Maple      'Q' encerrar
+ *                 'T' prazo por job em ms ("0" = sem prazo)
+ *   filho -> pai  'O' resultado (texto)  'E' mensagem de erro
+ *                 'X' prazo esgotado     'R' pronto para o próximo job
+ *
+ * Depois de responder, o filho faz `restart` e recarrega os pacotes
+ * ANTES de mandar 'R', de modo que esse custo fica fora do caminho
+ * do próximo job.
+ *
+ * Se um filho morre (crash do kernel, kill), o pai o recolhe com
+ * waitpid e sobe outro no mesmo lugar, com o mesmo preload e o
+ * prazo atual. Só o job que ele executava falha ("worker morreu");
+ * os demais seguem. Um filho que morre antes do primeiro 'R' (não
+ * conseguiu nem subir o kernel) continua derrubando o pool, para
+ * não ficar recriando processos que nunca vão funcionar.
+ */
+
+#ifndef KERNEL_POOL_HPP
+#define KERNEL_POOL_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "maple_kernel.hpp"
+
+// ===========================================
+// FRAMES NO SOCKET
+// ===========================================
+
+static bool writeAll(int fd, const void* buf, size_t len)
+{
+    const char* p = static_cast<const char*>(buf);
+    while(len > 0)
+    {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if(n <= 0)
+            return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool readAll(int fd, void* buf, size_t len)
+{
+    char* p = static_cast<char*>(buf);
+    while(len > 0)
+    {
+        ssize_t n = read(fd, p, len);
+        if(n <= 0)
+            return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool sendFrame(int fd, char type, const std::string& body)
+{
+    uint32_t len = static_cast<uint32_t>(body.size());
+    return writeAll(fd, &type, 1) && writeAll(fd, &len, sizeof len)
+           && writeAll(fd, body.data(), body.size());
+}
+
+static bool recvFrame(int fd, char& type, std::string& body)
+{
+    uint32_t len;
+    if(!readAll(fd, &type, 1) || !readAll(fd, &len, sizeof len))
+        return false;
+    body.resize(len);
+    return len == 0 || readAll(fd, &body[0], len);
+}
+
+// ===========================================
+// CLASSE KERNELPOOL
+// ===========================================
+
+class KernelPool
+{
+  public:
+    struct Result
+    {
+        bool        ok;        // false: erro do Maple (output = msg)
+        std::string output;    // resultado convertido em string
+        int         worker;    // índice do worker que executou
+        bool        timedOut;  // interrompido pelo prazo do job
+    };
+
+    static std::vector<std::string> defaultPackages()
+    {
+        return {"LinearAlgebra",
+                "plots",
+                "VectorCalculus",
+                "Optimization"};
+    }
+
+    KernelPool(size_t                   size,
+               int                      argc,
+               char**                   argv,
+               std::vector<std::string> packages = defaultPackages())
+        : argc(argc), argv(argv), packages(std::move(packages))
+    {
+        if(size == 0)
+            throw std::invalid_argument("pool vazio");
+
+        // resolve o libname antes do fork: os filhos herdam o
+        // resultado em memória
+        LibnameResolver::paths();
+
+        workers.resize(size);
+        for(size_t i = 0; i < size; ++i)
+            spawn(i);
+    }
+
+    ~KernelPool()
+    {
+        for(auto& w : workers)
+        {
+            if(w.fd < 0)
+                continue;
+            sendFrame(w.fd, 'Q', "");
+            close(w.fd);
+        }
+        for(auto& w : workers)
+        {
+            if(w.pid > 0)
+                waitpid(w.pid, nullptr, 0);
+        }
+    }
+
+    KernelPool(const KernelPool&)            = delete;
+    KernelPool& operator=(const KernelPool&) = delete;
+
+    size_t size() const
+    {
+        return workers.size();
+    }
+
+    // Bloqueia até que todos os workers tenham terminado o startup
+    void waitReady()
+    {
+        std::vector<Result> none;
+        size_t              done = 0;
+        for(;;)
+        {
+            bool all_idle = true;
+            for(const auto& w : workers)
+                all_idle = all_idle && w.idle;
+            if(all_idle)
+                return;
+            pump(none, done);
+        }
+    }
+
+    // Prazo de cada job a partir daqui (0 = sem prazo). Um job que
+    // estoura é interrompido pelo queryInterrupt do worker, que
+    // segue atendendo: não trava o pool nem a cauda de latência.
+    void setJobTimeout(std::chrono::milliseconds timeout)
+    {
+        std::vector<Result> none;
+        size_t              done = 0;
+        jobTimeout               = timeout;
+        for(size_t i = 0; i < workers.size(); ++i)
+        {
+            // um substituto já recebe o prazo novo no spawn
+            if(!sendFrame(workers[i].fd,
+                          'T',
+                          std::to_string(timeout.count())))
+                replace(i, none, done);
+        }
+    }
+
+    Result run(const std::string& command)
+    {
+        return runAll({command})[0];
+    }
+
+    // Distribui os comandos entre os workers ociosos e devolve os
+    // resultados na mesma ordem de `commands`.
+    std::vector<Result> runAll(const std::vector<std::string>& commands)
+    {
+        std::vector<Result> results(commands.size());
+        size_t              next = 0, done = 0;
+
+        while(done < commands.size())
+        {
+            for(size_t i = 0; i < workers.size(); ++i)
+            {
+                Worker& w = workers[i];
+                if(w.idle && next < commands.size())
+                {
+                    // o job não chegou ao worker: fica para o
+                    // próximo ocioso
+                    if(!sendFrame(w.fd, 'J', commands[next]))
+                    {
+                        replace(i, results, done);
+                        continue;
+                    }
+                    w.idle = false;
+                    w.job  = static_cast<long>(next++);
+                }
+            }
+            if(done < commands.size())
+                pump(results, done);
+        }
+        return results;
+    }
+
+  private:
+    struct Worker
+    {
+        pid_t pid     = -1;
+        int   fd      = -1;
+        bool  idle    = false;  // mandou 'R' e não recebeu job depois
+        bool  started = false;  // já mandou algum 'R'
+        long  job     = -1;     // comando em execução (-1 = nenhum)
+    };
+
+    int                       argc;
+    char**                    argv;
+    std::vector<std::string>  packages;
+    std::chrono::milliseconds jobTimeout{0};
+    std::vector<Worker>       workers;
+
+    // Sobe o filho do lugar `i` (startup ou substituição)
+    void spawn(size_t i)
+    {
+        int sv[2];
+        if(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0)
+            throw std::runtime_error("socketpair falhou");
+
+        // evita que buffers do pai sejam duplicados nos filhos
+        std::cout.flush();
+        std::cerr.flush();
+
+        pid_t pid = fork();
+        if(pid < 0)
+        {
+            close(sv[0]);
+            close(sv[1]);
+            throw std::runtime_error("fork falhou");
+        }
+
+        if(pid == 0)
+        {
+            close(sv[0]);
+            for(const auto& w : workers)
+            {
+                if(w.fd >= 0)
+                    close(w.fd);
+            }
+            workerMain(sv[1], argc, argv, packages);
+        }
+
+        close(sv[1]);
+        workers[i] = {pid, sv[0], false, false, -1};
+        // o filho lê o prazo depois do preload, antes do 1º job
+        if(jobTimeout.count() > 0)
+            sendFrame(sv[0], 'T', std::to_string(jobTimeout.count()));
+    }
+
+    // O filho `i` morreu: recolhe, falha só o job dele e sobe outro
+    void replace(size_t i, std::vector<Result>& results, size_t& done)
+    {
+        Worker& w = workers[i];
+        close(w.fd);
+        waitpid(w.pid, nullptr, 0);
+        w.fd  = -1;
+        w.pid = -1;
+        if(!w.started)
+            throw std::runtime_error("worker morreu na partida");
+
+        if(w.job >= 0 && static_cast<size_t>(w.job) < results.size())
+        {
+            results[static_cast<size_t>(w.job)]
+                = {false, "worker morreu", static_cast<int>(i), false};
+            ++done;
+        }
+        spawn(i);
+    }
+
+    // Espera pelo menos um frame de algum worker e o processa
+    void pump(std::vector<Result>& results, size_t& done)
+    {
+        std::vector<pollfd> fds;
+        for(const auto& w : workers)
+            fds.push_back({w.fd, POLLIN, 0});
+        if(poll(fds.data(), fds.size(), -1) < 0)
+            throw std::runtime_error("poll falhou");
+
+        for(size_t i = 0; i < workers.size(); ++i)
+        {
+            if(!(fds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+
+            Worker&     w = workers[i];
+            char        type;
+            std::string body;
+            if(!recvFrame(w.fd, type, body))
+            {
+                replace(i, results, done);
+                continue;
+            }
+
+            if(type == 'R')
+            {
+                w.idle    = true;
+                w.started = true;
+            }
+            else if(w.job >= 0)
+            {
+                results[static_cast<size_t>(w.job)]
+                    = {type == 'O', body, static_cast<int>(i),
+                       type == 'X'};
+                w.job = -1;
+                ++done;
+            }
+        }
+    }
+
+    [[noreturn]] static void workerMain(
+        int                             fd,
+        int                             argc,
+        char**                          argv,
+        const std::vector<std::string>& packages)
+    {
+        int status = 0;
+        try
+        {
+            MapleKernel maple{argc, argv};
+            maple.preload(packages);
+
+            char                      type;
+            std::string               job;
+            std::chrono::milliseconds timeout{0};
+            bool                      alive = sendFrame(fd, 'R', "");
+            while(alive && recvFrame(fd, type, job)
+                  && (type == 'J' || type == 'T'))
+            {
+                if(type == 'T')
+                {
+                    timeout = std::chrono::milliseconds(
+                        std::stoll(job));
+                    continue;
+                }
+
+                auto r = timeout.count() > 0
+                             ? maple.tryExecute(job, timeout)
+                             : maple.tryExecute(job);
+                if(r)
+                    alive = sendFrame(fd, 'O', maple.toString(*r));
+                else
+                    alive = sendFrame(
+                        fd,
+                        r.error().kind == MapleError::Timeout ? 'X'
+                                                              : 'E',
+                        r.error().message);
+
+                // prepara o próximo job fora do caminho crítico
+                maple.restart();
+                maple.preload(packages);
+                alive = alive && sendFrame(fd, 'R', "");
+            }
+        }
+        catch(const std::exception& e)
+        {
+            std::cerr << "worker " << getpid() << ": " << e.what()
+                      << "\n";
+            status = 1;
+        }
+        close(fd);
+        std::cout.flush();
+        _exit(status);
+    }
+};
+
+#endif /* KERNEL_POOL_HPP */
@@ -0,0 +1,181 @@
+/* lazy.cpp - with(...) na partida x require() na primeira referência
+ *
+ * Jobs de uma função só (os mesmos pacotes de 07-ex, 08-ex, 09-ex
+ * e 13-ex), medidos do kernel pronto até o primeiro resultado:
+ *
+ *   eager  with(Pkg): e depois Export(args)
+ *   lazy   maple.call("Pkg:-Export", args)
+ *
+ * Cada medida roda num processo novo (fork), senão o pacote já
+ * estaria carregado pela anterior. O pai confere que os dois modos
+ * devolvem o mesmo resultado.
+ *
+ * ./lazy [N]   (padrão: 10)
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "maple_kernel.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0)
+        .count();
+}
+
+struct Job
+{
+    const char* package;
+    const char* name;  // export
+    const char* arg1;  // argumentos, como expressões Maple
+    const char* arg2;  // nullptr: só um argumento
+};
+
+static const std::vector<Job> jobs = {
+    {"LinearAlgebra",
+     "Determinant",
+     "Matrix([[3, 8], [4, 6]])",
+     nullptr},
+    {"Optimization", "Maximize", "x*y", "{x^2 + y^2 <= 1}"},
+    {"VectorCalculus", "Laplacian", "x^2*y + z^3", "[x, y, z]"},
+    {"plots", "display", "plot(sin(x), x = 0..1)", nullptr}};
+
+struct Measure
+{
+    double      ms;
+    std::string result;
+};
+
+// Filho: kernel novo, um job, tempo e resultado em `fd`
+[[noreturn]] static void runJob(int fd, char* argv0, const Job& job,
+                                bool lazy)
+{
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);  // mensagens do kernel
+    close(null);
+
+    char*       args[] = {argv0, nullptr};
+    MapleKernel maple{1, args};
+    int         nargs = job.arg2 != nullptr ? 2 : 1;
+    maple.executeCommand("_a1 := " + std::string(job.arg1) + ":");
+    if(nargs == 2)
+        maple.executeCommand("_a2 := " + std::string(job.arg2)
+                             + ":");
+    ALGEB a1 = maple.executeCommand("_a1:");
+    ALGEB a2 = nargs == 2 ? maple.executeCommand("_a2:") : nullptr;
+
+    auto  t0 = Clock::now();
+    ALGEB r;
+    if(lazy)
+    {
+        std::string name
+            = std::string(job.package) + ":-" + job.name;
+        r = nargs == 2 ? maple.call(name, a1, a2)
+                       : maple.call(name, a1);
+    }
+    else
+    {
+        maple.executeCommand("with(" + std::string(job.package)
+                             + "):");
+        r = maple.executeCommand(std::string(job.name)
+                                 + (nargs == 2 ? "(_a1, _a2):"
+                                               : "(_a1):"));
+    }
+    double ms = msSince(t0);
+
+    std::string text = maple.toString(r);
+    text             = std::to_string(ms) + "\n" + text;
+    ssize_t n        = write(fd, text.data(), text.size());
+    _exit(n == static_cast<ssize_t>(text.size()) ? 0 : 1);
+}
+
+static Measure measure(char* argv0, const Job& job, bool lazy)
+{
+    int p[2];
+    if(pipe(p) != 0)
+        throw std::runtime_error("pipe falhou");
+    std::cout.flush();
+    pid_t pid = fork();
+    if(pid < 0)
+        throw std::runtime_error("fork falhou");
+    if(pid == 0)
+    {
+        close(p[0]);
+        runJob(p[1], argv0, job, lazy);
+    }
+    close(p[1]);
+
+    std::string out;
+    char        buf[4096];
+    ssize_t     n;
+    while((n = read(p[0], buf, sizeof buf)) > 0)
+        out.append(buf, static_cast<size_t>(n));
+    close(p[0]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    size_t nl = out.find('\n');
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0
+       || nl == std::string::npos)
+        throw std::runtime_error(std::string("job falhou: ")
+                                 + job.name);
+    return {std::atof(out.c_str()), out.substr(nl + 1)};
+}
+
+static double median(std::vector<double> v)
+{
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+int main(int argc, char* argv[])
+{
+    const int N = argc > 1 ? std::atoi(argv[1]) : 10;
+
+    try
+    {
+        if(N <= 0)
+            throw std::invalid_argument("N deve ser positivo");
+
+        std::cout << "=== Até o primeiro resultado, mediana de " << N
+                  << " partidas (ms) ===\n"
+                  << std::left << std::setw(30) << "job" << std::right
+                  << std::setw(10) << "with" << std::setw(10)
+                  << "require" << "  mesmo resultado\n"
+                  << std::fixed << std::setprecision(1);
+        for(const auto& job : jobs)
+        {
+            std::vector<double> eager, lazy;
+            bool                same = true;
+            for(int i = 0; i < N; ++i)
+            {
+                Measure e = measure(argv[0], job, false);
+                Measure l = measure(argv[0], job, true);
+                eager.push_back(e.ms);
+                lazy.push_back(l.ms);
+                same = same && e.result == l.result;
+            }
+            std::cout << std::left << std::setw(30)
+                      << std::string(job.package) + ":-" + job.name
+                      << std::right << std::setw(10) << median(eager)
+                      << std::setw(10) << median(lazy) << "  "
+                      << (same ? "sim" : "NÃO") << "\n";
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "\nFATAL EXCEPTION: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
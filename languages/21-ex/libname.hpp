@@ -0,0 +1,73 @@
+/* libname.hpp - LibnameResolver: o libname.h visto do C++
+ *
+ * A descoberta, a validação dos .mla e o cache em disco estão no
+ * libname.h, compartilhado com os exemplos em C. Aqui o resultado
+ * fica em memória por processo: restart() e os workers do
+ * KernelPool (fork) não repetem nem a leitura do cache.
+ */
+
+#ifndef LIBNAME_HPP
+#define LIBNAME_HPP
+
+#include <string>
+#include <vector>
+#include "../common/libname.h"
+
+class LibnameResolver
+{
+  public:
+    // Diretórios para o libname (vazio: nenhum Maple encontrado)
+    static const std::vector<std::string>& paths()
+    {
+        static const std::vector<std::string> resolved = toVector(
+            [](MapleLibname* l) { return maple_libname_resolve(l); });
+        return resolved;
+    }
+
+    // libname := "a", "b", libname:
+    static std::string statement(const std::vector<std::string>& dirs)
+    {
+        std::string s = "libname := ";
+        for(const auto& d : dirs)
+        {
+            s += '"';
+            for(char c : d)
+            {
+                if(c == '"' || c == '\\')
+                    s += '\\';
+                s += c;
+            }
+            s += "\", ";
+        }
+        return s + "libname:";
+    }
+
+    // Descobre de novo e regrava o cache (ignora o cache atual)
+    static std::vector<std::string> discover()
+    {
+        return toVector(
+            [](MapleLibname* l) { return maple_libname_discover(l); });
+    }
+
+    static std::string cachePath()
+    {
+        char path[MAPLE_LIBNAME_LEN];
+        if(!maple_libname_cache_path(path, sizeof path))
+            return "";
+        return path;
+    }
+
+  private:
+    template <typename F>
+    static std::vector<std::string> toVector(F fill)
+    {
+        MapleLibname             l;
+        std::vector<std::string> dirs;
+        fill(&l);
+        for(int i = 0; i < l.n; ++i)
+            dirs.emplace_back(l.dir[i]);
+        return dirs;
+    }
+};
+
+#endif /* LIBNAME_HPP */
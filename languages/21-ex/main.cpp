@@ -0,0 +1,76 @@
+/* main.cpp - Pool de kernels Maple pré-aquecidos
+ *
+ * Sobe N workers (padrão 4, ou MAPLE_POOL_SIZE) com libname e os
+ * pacotes LinearAlgebra, plots, VectorCalculus e Optimization já
+ * carregados, e distribui um lote de jobs curtos entre eles. Cada
+ * job tem prazo (MAPLE_JOB_TIMEOUT ms, padrão 2000): a integral
+ * "fugitiva" do fim do lote é interrompida sem travar o worker.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "kernel_pool.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0)
+        .count();
+}
+
+int main(int argc, char* argv[])
+{
+    size_t n = 4;
+    if(const char* env = std::getenv("MAPLE_POOL_SIZE"))
+        n = static_cast<size_t>(std::atoi(env));
+    long timeout_ms = 2000;
+    if(const char* env = std::getenv("MAPLE_JOB_TIMEOUT"))
+        timeout_ms = std::atol(env);
+
+    try
+    {
+        auto       t0 = Clock::now();
+        KernelPool pool{n, argc, argv};
+        pool.waitReady();
+        std::cout << "✅ " << pool.size() << " workers prontos em "
+                  << msSince(t0) << " ms\n";
+        pool.setJobTimeout(std::chrono::milliseconds(timeout_ms));
+
+        // jobs curtos que usam os pacotes pré-carregados
+        std::vector<std::string> jobs;
+        for(int k = 1; k <= 16; ++k)
+        {
+            jobs.push_back("Determinant(Matrix(" + std::to_string(k + 2)
+                           + ", (i,j) -> 1/(i+j-1)));");
+            jobs.push_back("int(sin(x)^" + std::to_string(k)
+                           + ", x = 0..Pi);");
+        }
+        jobs.push_back("int(1/0, x);");  // erro proposital
+        jobs.push_back("int(1/(randpoly(x)^4+1), x);");  // estoura
+
+        t0           = Clock::now();
+        auto results = pool.runAll(jobs);
+        double ms    = msSince(t0);
+
+        for(size_t i = 0; i < results.size(); ++i)
+        {
+            std::cout << "[w" << results[i].worker << "] " << jobs[i]
+                      << (results[i].ok         ? "  =>  "
+                          : results[i].timedOut ? "  ⏱  "
+                                                : "  !!  ")
+                      << results[i].output << "\n";
+        }
+        std::cout << "\n✅ " << jobs.size() << " jobs em " << ms
+                  << " ms (" << ms / jobs.size() << " ms/job)\n";
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "\nFATAL EXCEPTION: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
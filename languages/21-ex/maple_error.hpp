@@ -0,0 +1,180 @@
+/* maple_error.hpp - Erro estruturado do kernel + Expected<T, E>
+ *
+ * Até aqui o errorCallBack só imprimia `msg` em stderr e quem
+ * chamava descobria a falha por `result == NULL`. O MapleError
+ * guarda tipo, offset, mensagem e o comando que falhou em buffers
+ * de tamanho fixo: o slot fica dentro do MapleKernel e o caminho
+ * sem erro não aloca nada.
+ *
+ * Expected<T, E> segue a interface de std::expected (C++23), que o
+ * g++ 12 ainda não tem: has_value()/operator bool, value() (lança),
+ * error(), operator*, operator-> e value_or().
+ */
+
+#ifndef MAPLE_ERROR_HPP
+#define MAPLE_ERROR_HPP
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include "maplec.h"
+
+// ===========================================
+// MAPLEERROR
+// ===========================================
+
+struct MapleError
+{
+    enum Kind
+    {
+        None,     // sem erro
+        Syntax,   // erro do parser (offset >= 0 no comando)
+        Runtime,  // erro na avaliação
+        Timeout   // interrompido pelo prazo (executeCommand(.., t))
+    };
+
+    Kind  kind   = None;
+    M_INT offset = -1;  // posição no comando (Syntax), senão -1
+    char  message[1024]   = "";
+    char  statement[1024] = "";  // comando que falhou (truncado)
+
+    explicit operator bool() const
+    {
+        return kind != None;
+    }
+
+    // Chamado a cada avaliação: só zera o tipo, sem tocar nos
+    // buffers
+    void clear()
+    {
+        kind = None;
+    }
+
+    void set(Kind k, M_INT off, const char* msg, const char* stmt)
+    {
+        kind   = k;
+        offset = off;
+        copy(message, msg);
+        copy(statement, stmt);
+    }
+
+    const char* kindName() const
+    {
+        switch(kind)
+        {
+        case Syntax:
+            return "syntax";
+        case Runtime:
+            return "runtime";
+        case Timeout:
+            return "timeout";
+        default:
+            return "none";
+        }
+    }
+
+  private:
+    template <size_t N>
+    static void copy(char (&dst)[N], const char* src)
+    {
+        if(src == nullptr)
+            src = "";
+        std::strncpy(dst, src, N - 1);
+        dst[N - 1] = '\0';
+    }
+};
+
+// ===========================================
+// EXPECTED
+// ===========================================
+
+class BadExpectedAccess : public std::runtime_error
+{
+  public:
+    using std::runtime_error::runtime_error;
+};
+
+template <typename E>
+struct Unexpected
+{
+    E error;
+};
+
+template <typename E>
+Unexpected<E> unexpected(E e)
+{
+    return {std::move(e)};
+}
+
+template <typename T, typename E>
+class Expected
+{
+  private:
+    std::variant<T, E> v;
+
+  public:
+    Expected(T value) : v(std::in_place_index<0>, std::move(value))
+    {
+    }
+
+    Expected(Unexpected<E> u)
+        : v(std::in_place_index<1>, std::move(u.error))
+    {
+    }
+
+    bool has_value() const
+    {
+        return v.index() == 0;
+    }
+
+    explicit operator bool() const
+    {
+        return has_value();
+    }
+
+    const T& value() const
+    {
+        if(!has_value())
+            throw BadExpectedAccess("Expected::value() sem valor");
+        return std::get<0>(v);
+    }
+
+    const E& error() const
+    {
+        return std::get<1>(v);
+    }
+
+    const T& operator*() const
+    {
+        return std::get<0>(v);
+    }
+
+    const T* operator->() const
+    {
+        return &std::get<0>(v);
+    }
+
+    T value_or(T alt) const
+    {
+        return has_value() ? std::get<0>(v) : std::move(alt);
+    }
+};
+
+// value() de Expected<ALGEB, MapleError> lança com a mensagem do
+// Maple em vez da genérica
+template <>
+inline const ALGEB& Expected<ALGEB, MapleError>::value() const
+{
+    if(!has_value())
+    {
+        const MapleError& e = std::get<1>(v);
+        throw BadExpectedAccess(std::string(e.kindName()) + ": "
+                                + e.message + " [" + e.statement
+                                + "]");
+    }
+    return std::get<0>(v);
+}
+
+#endif /* MAPLE_ERROR_HPP */
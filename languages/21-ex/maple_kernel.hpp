@@ -0,0 +1,955 @@
+/* maple_kernel.hpp - Classe MapleKernel compartilhada pelos
+ * exemplos do 21-ex
+ *
+ * Mesma classe dos main.cpp de 10-ex a 18-ex, agora num header
+ * para ser reutilizada pelo pool de kernels e pelos demais
+ * programas deste diretório.
+ */
+
+#ifndef MAPLE_KERNEL_HPP
+#define MAPLE_KERNEL_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include "maplec.h"
+#include "capture.hpp"
+#include "input_feeder.hpp"
+#include "libname.hpp"
+#include "maple_error.hpp"
+#include "output_sink.hpp"
+#include "rpc.hpp"
+#include "streams.hpp"
+#include "telemetry.hpp"
+
+// ===========================================
+// CALLBACKS
+// ===========================================
+
+// Estado visto pelos callbacks: é o `data` passado ao StartMaple
+// (ver construtor do MapleKernel)
+struct CallbackState
+{
+    using Clock = std::chrono::steady_clock;
+
+    MapleError       error;                 // slot do último erro
+    const char*      statement  = nullptr;  // comando em avaliação
+    bool             echoErrors = true;     // erros também em cerr
+    OutputSink*      output     = nullptr;  // nullptr: std::cout
+    KernelTelemetry* telemetry  = nullptr;  // nullptr: desligada
+    RpcRegistry*     rpc        = nullptr;  // handlers de callback()
+    StreamRegistry*  streams    = nullptr;  // de streamcall()
+    RedirectTable*   redirect   = nullptr;  // writeto/appendto
+    InputFeeder*     input      = nullptr;  // nullptr: std::cin
+
+    // prazo da chamada em curso (max: sem prazo), lido pelo
+    // queryInterrupt; timedOut indica que foi ele quem interrompeu
+    Clock::time_point deadline = Clock::time_point::max();
+    bool              timedOut = false;
+};
+
+static void M_DECL textCallBack(void* data,
+                                int tag,
+                                const char* output)
+{
+    auto* state = static_cast<CallbackState*>(data);
+    if(state != nullptr && state->redirect != nullptr
+       && state->redirect->active())
+        state->redirect->write(output);
+    else if(state != nullptr && state->output != nullptr)
+        state->output->push(tag, output);
+    else
+        std::cout << ">> Maple: " << output << "\n";
+}
+
+// Preenche o slot de erro do kernel; offset >= 0 só em erros do
+// parser
+static void M_DECL errorCallBack(void* data,
+                                 M_INT offset,
+                                 const char* msg)
+{
+    auto* state = static_cast<CallbackState*>(data);
+    if(state != nullptr)
+    {
+        state->error.set(offset >= 0 ? MapleError::Syntax
+                                     : MapleError::Runtime,
+                         offset,
+                         msg,
+                         state->statement);
+        if(!state->echoErrors)
+            return;
+    }
+    std::cerr << "❌ Maple Error: " << msg << "\n";
+}
+
+// kilobytes usados/alocados e CPU (s) a cada coleta de lixo
+static void M_DECL statusCallBack(void*  data,
+                                  long   kilobytesUsed,
+                                  long   kilobytesAlloc,
+                                  double cpuTime)
+{
+    auto* state = static_cast<CallbackState*>(data);
+    if(state != nullptr && state->telemetry != nullptr)
+    {
+        state->telemetry->onStatus(
+            kilobytesUsed, kilobytesAlloc, cpuTime);
+    }
+}
+
+// callback(...) no Maple; ver rpc.hpp
+static char* M_DECL callBackCallBack(void* data, char* args)
+{
+    auto* state = static_cast<CallbackState*>(data);
+    if(state == nullptr || state->rpc == nullptr)
+        return nullptr;
+    return state->rpc->dispatch(args);
+}
+
+// readline() e prompts do depurador; ver input_feeder.hpp
+static char* M_DECL readLineCallBack(void* data, M_BOOL debug)
+{
+    auto* state = static_cast<CallbackState*>(data);
+    if(state != nullptr && state->input != nullptr)
+        return state->input->next(debug != FALSE);
+
+    static std::string line;  // como no 19-ex: lê do terminal
+    std::cout << (debug ? "\nDBG ---> " : "\n---> ") << std::flush;
+    if(!std::getline(std::cin, line))
+        line = debug ? "quit" : "";
+    return &line[0];
+}
+
+// writeto(name) / appendto(name) / writeto(terminal); ver
+// capture.hpp
+static M_BOOL M_DECL redirectCallBack(void*       data,
+                                      const char* name,
+                                      const char* mode)
+{
+    auto* state = static_cast<CallbackState*>(data);
+    if(state == nullptr || state->redirect == nullptr)
+        return FALSE;
+    return state->redirect->redirect(name, mode) ? TRUE : FALSE;
+}
+
+// streamcall(INTERFACE_name(...)) no Maple; ver streams.hpp
+static char* M_DECL streamCallBack(void*       data,
+                                   const char* name,
+                                   M_INT       nargs,
+                                   char**      args)
+{
+    auto* state = static_cast<CallbackState*>(data);
+    if(state == nullptr || state->streams == nullptr)
+        return nullptr;
+    return state->streams->dispatch(name, nargs, args);
+}
+
+// Chamado periodicamente pelo kernel durante a avaliação; TRUE
+// interrompe a computação (o kernel continua utilizável)
+static M_BOOL M_DECL queryInterrupt(void* data)
+{
+    auto* state = static_cast<CallbackState*>(data);
+    if(state == nullptr
+       || state->deadline == CallbackState::Clock::time_point::max())
+        return FALSE;
+    if(CallbackState::Clock::now() < state->deadline)
+        return FALSE;
+    state->timedOut = true;
+    return TRUE;
+}
+
+// Lançada quando uma avaliação com prazo é interrompida por ele
+class MapleTimeout : public std::runtime_error
+{
+  public:
+    using std::runtime_error::runtime_error;
+};
+
+// Geração do kernel: muda a cada restart() e no StopMaple. Um
+// handle protegido numa geração anterior já não existe e não pode
+// passar por MapleGcAllow. O OpenMaple só tem um kernel por
+// processo, por isso o contador é global.
+inline unsigned long& kernelGeneration()
+{
+    static unsigned long generation = 0;
+    return generation;
+}
+
+// ===========================================
+// PREPARED STATEMENT
+// ===========================================
+
+// Comando Maple com parâmetros `?`, analisado uma única vez.
+//
+// prepare("eval(df, x = ?)") vira o procedimento
+//   proc(_p1) eval(df, x = _p1) end proc
+// que é chamado direto com EvalMapleProc / EvalhfMapleProc, sem
+// sprintf nem parser a cada chamada. Depois de um restart() o
+// procedimento deixa de existir: chamar lança std::logic_error e o
+// destrutor não toca no kernel.
+class PreparedStatement
+{
+  private:
+    MKernelVector kv    = nullptr;
+    ALGEB         proc  = nullptr;
+    int           arity = 0;
+    unsigned long gen   = 0;  // kernelGeneration() na criação
+
+    void checkGeneration() const
+    {
+        if(gen != kernelGeneration())
+            throw std::logic_error(
+                "PreparedStatement de antes do restart()");
+    }
+
+  public:
+    // Conversões C++ -> ALGEB (também usadas por MapleKernel::call)
+    static ALGEB toAlgeb(MKernelVector /* k */, ALGEB a)
+    {
+        return a;
+    }
+    static ALGEB toAlgeb(MKernelVector k, double d)
+    {
+        return ToMapleFloat(k, d);
+    }
+    static ALGEB toAlgeb(MKernelVector k, int i)
+    {
+        return ToMapleInteger(k, i);
+    }
+    static ALGEB toAlgeb(MKernelVector k, long i)
+    {
+        return ToMapleInteger(k, i);
+    }
+    static ALGEB toAlgeb(MKernelVector k, const char* s)
+    {
+        return ToMapleString(k, s);
+    }
+    static ALGEB toAlgeb(MKernelVector k, const std::string& s)
+    {
+        return ToMapleString(k, s.c_str());
+    }
+
+    PreparedStatement() = default;
+
+    PreparedStatement(MKernelVector k, ALGEB p, int n)
+        : kv(k), proc(p), arity(n), gen(kernelGeneration())
+    {
+        MapleGcProtect(kv, proc);
+    }
+
+    ~PreparedStatement()
+    {
+        if(proc != nullptr && gen == kernelGeneration())
+            MapleGcAllow(kv, proc);
+    }
+
+    PreparedStatement(const PreparedStatement&)            = delete;
+    PreparedStatement& operator=(const PreparedStatement&) = delete;
+
+    PreparedStatement(PreparedStatement&& o) noexcept
+        : kv(o.kv), proc(std::exchange(o.proc, nullptr)),
+          arity(o.arity), gen(o.gen)
+    {
+    }
+
+    PreparedStatement& operator=(PreparedStatement&& o) noexcept
+    {
+        std::swap(kv, o.kv);
+        std::swap(proc, o.proc);
+        std::swap(arity, o.arity);
+        std::swap(gen, o.gen);
+        return *this;
+    }
+
+    int getArity() const
+    {
+        return arity;
+    }
+
+    ALGEB getProcedure() const
+    {
+        return proc;
+    }
+
+    // Avaliação geral: double, int/long, strings e ALGEB
+    template <typename... Args>
+    ALGEB operator()(const Args&... args) const
+    {
+        if(static_cast<int>(sizeof...(Args)) != arity)
+            throw std::invalid_argument("número de argumentos");
+        checkGeneration();
+        return EvalMapleProc(kv,
+                             proc,
+                             static_cast<int>(sizeof...(Args)),
+                             toAlgeb(kv, args)...);
+    }
+
+    // Avaliação em hardware floats (evalhf): só doubles.
+    // EvalhfMapleProc usa args[1..n]; args[0] não é lido.
+    template <typename... Args>
+    double evalhf(Args... args) const
+    {
+        if(static_cast<int>(sizeof...(Args)) != arity)
+            throw std::invalid_argument("número de argumentos");
+        checkGeneration();
+        double argv[] = {0.0, static_cast<double>(args)...};
+        return EvalhfMapleProc(
+            kv, proc, static_cast<int>(sizeof...(Args)), argv);
+    }
+};
+
+// ===========================================
+// RTABLE VIEW (ZERO-COPY)
+// ===========================================
+
+// data_type do RTable correspondente a cada tipo C++
+template <typename T>
+struct RTableType;
+template <>
+struct RTableType<double>
+{
+    static constexpr int value = RTABLE_FLOAT64;
+};
+template <>
+struct RTableType<float>
+{
+    static constexpr int value = RTABLE_FLOAT32;
+};
+template <>
+struct RTableType<int64_t>
+{
+    static constexpr int value = RTABLE_INTEGER64;
+};
+template <>
+struct RTableType<int32_t>
+{
+    static constexpr int value = RTABLE_INTEGER32;
+};
+template <>
+struct RTableType<int8_t>
+{
+    static constexpr int value = RTABLE_INTEGER8;
+};
+
+// Visão tipada sobre o bloco de dados de um RTable (Vector/Matrix
+// densos de 1 ou 2 dimensões). Nada é copiado: o ponteiro é o
+// próprio RTableDataBlock. O RTable fica protegido do GC enquanto a
+// visão existir, ou até o próximo restart(): daí em diante data()
+// não vale mais e o destrutor não toca no kernel.
+template <typename T>
+class RTableView
+{
+  private:
+    MKernelVector kv     = nullptr;
+    ALGEB         rtable = nullptr;
+    T*            ptr    = nullptr;
+    size_t        nrows  = 0;
+    size_t        ncols  = 0;
+    int           order  = RTABLE_C;
+    unsigned long gen    = 0;  // kernelGeneration() na criação
+
+  public:
+    RTableView() = default;
+
+    RTableView(MKernelVector k, ALGEB rt)
+        : kv(k), rtable(rt), gen(kernelGeneration())
+    {
+        if(rt == nullptr || !IsMapleRTable(kv, rt))
+            throw std::invalid_argument("view: não é um RTable");
+
+        RTableSettings rts;
+        RTableGetSettings(kv, &rts, rt);
+        if(rts.data_type != RTableType<T>::value)
+            throw std::invalid_argument("view: datatype diferente");
+        if(rts.storage != RTABLE_RECT)
+            throw std::invalid_argument("view: storage não retangular");
+        if(rts.num_dimensions < 1 || rts.num_dimensions > 2)
+            throw std::invalid_argument("view: só 1 ou 2 dimensões");
+
+        nrows = static_cast<size_t>(RTableUpperBound(kv, rt, 1)
+                                    - RTableLowerBound(kv, rt, 1) + 1);
+        ncols = rts.num_dimensions == 2
+                    ? static_cast<size_t>(RTableUpperBound(kv, rt, 2)
+                                          - RTableLowerBound(kv, rt, 2)
+                                          + 1)
+                    : 1;
+        order = rts.order;
+        ptr   = static_cast<T*>(RTableDataBlock(kv, rt));
+        MapleGcProtect(kv, rtable);
+    }
+
+    ~RTableView()
+    {
+        if(rtable != nullptr && gen == kernelGeneration())
+            MapleGcAllow(kv, rtable);
+    }
+
+    RTableView(const RTableView&)            = delete;
+    RTableView& operator=(const RTableView&) = delete;
+
+    RTableView(RTableView&& o) noexcept
+        : kv(o.kv), rtable(std::exchange(o.rtable, nullptr)),
+          ptr(o.ptr), nrows(o.nrows), ncols(o.ncols), order(o.order),
+          gen(o.gen)
+    {
+    }
+
+    RTableView& operator=(RTableView&& o) noexcept
+    {
+        std::swap(kv, o.kv);
+        std::swap(rtable, o.rtable);
+        std::swap(ptr, o.ptr);
+        std::swap(nrows, o.nrows);
+        std::swap(ncols, o.ncols);
+        std::swap(order, o.order);
+        std::swap(gen, o.gen);
+        return *this;
+    }
+
+    // O RTable em si, para passar a EvalMapleProc / PreparedStatement
+    ALGEB algeb() const
+    {
+        return rtable;
+    }
+
+    T* data() const
+    {
+        return ptr;
+    }
+    size_t size() const
+    {
+        return nrows * ncols;
+    }
+    size_t rows() const
+    {
+        return nrows;
+    }
+    size_t cols() const
+    {
+        return ncols;
+    }
+    T* begin() const
+    {
+        return ptr;
+    }
+    T* end() const
+    {
+        return ptr + size();
+    }
+    std::span<T> span() const
+    {
+        return {ptr, size()};
+    }
+
+    // Acesso linear (ordem de armazenamento), sem verificação
+    T& operator[](size_t i) const
+    {
+        return ptr[i];
+    }
+
+    // Acesso (i, j) base 0, respeitando C_order / Fortran_order
+    T& operator()(size_t i, size_t j) const
+    {
+        return order == RTABLE_C ? ptr[i * ncols + j]
+                                 : ptr[j * nrows + i];
+    }
+
+    T& at(size_t i, size_t j = 0) const
+    {
+        if(i >= nrows || j >= ncols)
+            throw std::out_of_range("RTableView::at");
+        return (*this)(i, j);
+    }
+};
+
+// ===========================================
+// CLASSE MAPLEKERNEL
+// ===========================================
+
+class MapleKernel
+{
+  private:
+    MKernelVector                    kv;
+    CallbackState                    callbacks;
+    std::unique_ptr<OutputSink>      output;
+    std::unique_ptr<KernelTelemetry> telemetry;
+    std::unique_ptr<RpcRegistry>     rpcRegistry;
+    std::unique_ptr<StreamRegistry>  streamRegistry;
+    RedirectTable                    redirects;
+    std::unique_ptr<InputFeeder>     feeder;
+
+    // Exports resolvidos por require(), protegidos do GC
+    std::unordered_map<std::string, ALGEB> exports;
+
+    // Um único `libname := ...` com os diretórios já validados pelo
+    // LibnameResolver; sem Maple encontrado, mantém o caminho padrão
+    void configureLibname()
+    {
+        const auto& dirs = LibnameResolver::paths();
+        executeCommand(dirs.empty()
+                           ? LibnameResolver::statement(
+                               {"/opt/maple2021/lib"})
+                           : LibnameResolver::statement(dirs));
+    }
+
+  public:
+    MapleKernel(int argc, char** argv)
+    {
+        char                err[2048];
+        MCallBackVectorDesc cb = {textCallBack,
+                                  errorCallBack,
+                                  statusCallBack,
+                                  readLineCallBack,
+                                  redirectCallBack,
+                                  streamCallBack,
+                                  queryInterrupt,
+                                  callBackCallBack};
+        std::cout << "🍁 Inicializando Kernel Maple...\n";
+        callbacks.redirect = &redirects;
+        kv = StartMaple(argc, argv, &cb, &callbacks, nullptr, err);
+
+        if(kv == nullptr)
+        {
+            throw std::runtime_error(
+                std::string("Falha ao iniciar Maple: ") + err);
+        }
+
+        configureLibname();
+        std::cout << "✅ Kernel Maple inicializado com sucesso!\n";
+    }
+
+    ~MapleKernel()
+    {
+        if(kv != nullptr)
+        {
+            if(output)
+                output->flush();
+            std::cout << "\n🛑 Encerrando Kernel Maple...\n";
+            StopMaple(kv);
+            ++kernelGeneration();
+        }
+    }
+
+    // O kernel é único por processo: não copiar
+    MapleKernel(const MapleKernel&)            = delete;
+    MapleKernel& operator=(const MapleKernel&) = delete;
+
+    // Getter Público: Necessário para usar MapleALGEB_Printf (C
+    // API)
+    MKernelVector getKernelVector() const
+    {
+        return kv;
+    }
+
+    ALGEB executeCommand(const std::string& command)
+    {
+        const char* outer = callbacks.statement;  // handlers aninhados
+        callbacks.error.clear();
+        callbacks.statement = command.c_str();
+        if(outer == nullptr && feeder)
+            feeder->beginEvaluation();
+        ALGEB r;
+        if(!telemetry)
+        {
+            r = EvalMapleStatement(kv, command.c_str());
+        }
+        else
+        {
+            telemetry->begin(command);
+            r = EvalMapleStatement(kv, command.c_str());
+            telemetry->end();
+        }
+        callbacks.statement = outer;
+        return r;
+    }
+
+    // Como executeCommand, mas a falha volta como MapleError
+    // (tipo, offset, mensagem e comando) em vez de NULL:
+    //   auto r = maple.tryExecute("with(Pkg):");
+    //   if(!r && r.error().kind == MapleError::Runtime) ...
+    Expected<ALGEB, MapleError> tryExecute(const std::string& command)
+    {
+        ALGEB r = executeCommand(command);
+        if(callbacks.error)
+            return unexpected(callbacks.error);
+        return r;
+    }
+
+    // Roda `eval` (qualquer chamada à API: executeCommand,
+    // PreparedStatement, EvalMapleProc...) com prazo. Prazos
+    // aninhados valem o menor.
+    template <typename F>
+    auto withDeadline(std::chrono::milliseconds timeout, F&& eval)
+    {
+        // restaura o prazo anterior mesmo se `eval` lançar
+        struct Restore
+        {
+            CallbackState&                   s;
+            CallbackState::Clock::time_point previous;
+            ~Restore()
+            {
+                s.deadline = previous;
+                s.timedOut = false;
+            }
+        } restore{callbacks, callbacks.deadline};
+
+        callbacks.deadline = std::min(
+            restore.previous, CallbackState::Clock::now() + timeout);
+        callbacks.timedOut = false;
+
+        auto r = eval();
+        if(callbacks.timedOut)
+        {
+            throw MapleTimeout("tempo esgotado ("
+                               + std::to_string(timeout.count())
+                               + " ms)");
+        }
+        return r;
+    }
+
+    // Como executeCommand(command), mas interrompe a avaliação se
+    // ela passar de `timeout` (relógio monotônico) e lança
+    // MapleTimeout. Ex.: executeCommand("int(...);", 2000ms)
+    ALGEB executeCommand(const std::string&        command,
+                         std::chrono::milliseconds timeout)
+    {
+        return withDeadline(timeout,
+                            [&] { return executeCommand(command); });
+    }
+
+    // Com prazo: o estouro vira MapleError::Timeout em vez de
+    // MapleTimeout
+    Expected<ALGEB, MapleError>
+    tryExecute(const std::string&        command,
+               std::chrono::milliseconds timeout)
+    {
+        try
+        {
+            return withDeadline(timeout,
+                                [&] { return tryExecute(command); });
+        }
+        catch(const MapleTimeout& e)
+        {
+            callbacks.error.set(
+                MapleError::Timeout, -1, e.what(), command.c_str());
+            return unexpected(callbacks.error);
+        }
+    }
+
+    // Mensagem do último erro reportado pelo kernel ("" se nenhum)
+    std::string getLastError() const
+    {
+        return callbacks.error ? callbacks.error.message : "";
+    }
+
+    // O slot de erro completo da última avaliação
+    const MapleError& lastError() const
+    {
+        return callbacks.error;
+    }
+
+    // false: erros só vão para o slot (sem "❌ Maple Error" em cerr)
+    void setErrorEcho(bool on)
+    {
+        callbacks.echoErrors = on;
+    }
+
+    // Passa o texto do textCallBack por um OutputSink: o kernel só
+    // copia para o ring e a escrita fica na thread de drenagem.
+    // Ex.: setOutputSink(std::make_unique<OutputSink>(
+    //          OutputSink::toFile("maple.log"),
+    //          OutputSink::Policy::Spill));
+    // nullptr volta a escrever direto no std::cout.
+    void setOutputSink(std::unique_ptr<OutputSink> sink)
+    {
+        if(output)
+            output->flush();
+        callbacks.output = sink.get();
+        output           = std::move(sink);
+    }
+
+    OutputSink* getOutputSink() const
+    {
+        return output.get();
+    }
+
+    // Liga a telemetria de memória/GC/CPU por comando (ver
+    // telemetry.hpp). gcfreq > 0 ajusta kernelopts(gcfreq): GCs mais
+    // frequentes dão mais pontos na série de status.
+    KernelTelemetry& enableTelemetry(long gcfreq = 0)
+    {
+        if(gcfreq > 0)
+        {
+            MapleKernelOptions(
+                kv, "gcfreq", ToMapleInteger(kv, gcfreq));
+        }
+        if(!telemetry)
+        {
+            telemetry = std::make_unique<KernelTelemetry>(kv);
+            callbacks.telemetry = telemetry.get();
+        }
+        return *telemetry;
+    }
+
+    KernelTelemetry* getTelemetry() const
+    {
+        return telemetry.get();
+    }
+
+    // Handlers C++ chamáveis do Maple pelo nome (ver rpc.hpp).
+    // Ex.: maple.rpc().add("sq", [](double x) { return x * x; });
+    RpcRegistry& rpc()
+    {
+        if(!rpcRegistry)
+        {
+            rpcRegistry   = std::make_unique<RpcRegistry>(kv);
+            callbacks.rpc = rpcRegistry.get();
+        }
+        return *rpcRegistry;
+    }
+
+    // writeto(name)/appendto(name) passam a ir para um buffer em
+    // memória (ver capture.hpp). Ex.:
+    //   auto dump = maple.capture("dump");
+    //   maple.executeCommand("writeto(\"dump\"); lprint(M);"
+    //                        " writeto(terminal);");
+    //   std::string_view s = dump->view();
+    std::shared_ptr<CaptureBuffer>
+    capture(const std::string& name,
+            size_t             spillThreshold = size_t{64} << 20)
+    {
+        return redirects.add(name, spillThreshold);
+    }
+
+    // Modo captura: todo writeto/appendto vai para memória; os
+    // buffers ficam em captured(name)
+    void captureAll(bool on = true)
+    {
+        redirects.setCaptureAll(on);
+    }
+
+    std::shared_ptr<CaptureBuffer> captured(const std::string& name)
+    {
+        return redirects.find(name);
+    }
+
+    // Entrada roteirizada para readline() e para o depurador, sem
+    // terminal (ver input_feeder.hpp). Ex.:
+    //   maple.input().pushLines("7;\n\"sim\";");
+    //   maple.input().setDebugPolicy(InputFeeder::DebugPolicy::Quit);
+    InputFeeder& input()
+    {
+        if(!feeder)
+        {
+            feeder          = std::make_unique<InputFeeder>();
+            callbacks.input = feeder.get();
+        }
+        return *feeder;
+    }
+
+    // Handlers de streamcall(INTERFACE_name(...)) (ver streams.hpp)
+    StreamRegistry& streams()
+    {
+        if(!streamRegistry)
+        {
+            streamRegistry    = std::make_unique<StreamRegistry>(kv);
+            callbacks.streams = streamRegistry.get();
+        }
+        return *streamRegistry;
+    }
+
+    // Analisa `statement` uma vez; cada `?` vira um parâmetro
+    // posicional. Não contam os `?` dentro de "strings" e `nomes`
+    // (com escapes \" e \`); comentários # são removidos. Ex.:
+    // prepare("fib(?)")
+    PreparedStatement prepare(const std::string& statement)
+    {
+        std::string body;
+        int         n       = 0;
+        char        quote   = 0;  // '"' ou '`' enquanto dentro
+        bool        escaped = false;
+        bool        comment = false;
+        for(char c : statement)
+        {
+            if(comment && c != '\n')
+                continue;
+            comment = false;
+            if(quote != 0)
+            {
+                if(escaped)
+                    escaped = false;
+                else if(c == '\\')
+                    escaped = true;
+                else if(c == quote)
+                    quote = 0;
+            }
+            else if(c == '"' || c == '`')
+                quote = c;
+            else if(c == '#')
+            {
+                comment = true;
+                continue;
+            }
+            else if(c == '?')
+            {
+                body += "_p" + std::to_string(++n);
+                continue;
+            }
+            body += c;
+        }
+        while(!body.empty()
+              && (body.back() == ';' || body.back() == ':'
+                  || body.back() == ' ' || body.back() == '\n'))
+            body.pop_back();
+
+        std::string params;
+        for(int i = 1; i <= n; ++i)
+            params += (i > 1 ? ", _p" : "_p") + std::to_string(i);
+
+        ALGEB p = executeCommand("proc(" + params + ") " + body
+                                 + " end proc:");
+        if(p == nullptr || !IsMapleProcedure(kv, p))
+        {
+            throw std::runtime_error("prepare falhou: " + statement
+                                     + " (" + getLastError() + ")");
+        }
+        return PreparedStatement(kv, p, n);
+    }
+
+    // Visão tipada e sem cópia de um RTable devolvido pelo Maple.
+    // Ex.: auto m = maple.view<double>(r); m(0, 1) = 2.0;
+    template <typename T>
+    RTableView<T> view(ALGEB rtable)
+    {
+        return RTableView<T>(kv, rtable);
+    }
+
+    // RTable "foreign" sobre memória C++ (Vector se cols == 0,
+    // Matrix rows x cols caso contrário). O Maple lê e escreve
+    // direto em `data`, que precisa viver mais que a visão.
+    template <typename T>
+    RTableView<T> wrap(std::span<T> data,
+                       size_t       rows  = 0,
+                       size_t       cols  = 0,
+                       int          order = RTABLE_C)
+    {
+        if(rows == 0)
+            rows = data.size();
+        if(rows * (cols == 0 ? 1 : cols) != data.size())
+            throw std::invalid_argument("wrap: dimensões != size");
+
+        RTableSettings rts;
+        M_INT          bounds[4] = {1, static_cast<M_INT>(rows), 1,
+                                    static_cast<M_INT>(cols)};
+        RTableGetDefaults(kv, &rts);
+        rts.data_type      = RTableType<T>::value;
+        rts.num_dimensions = cols == 0 ? 1 : 2;
+        rts.subtype = cols == 0 ? RTABLE_COLUMN : RTABLE_MATRIX;
+        rts.order   = order;
+        rts.foreign = TRUE;
+        return RTableView<T>(
+            kv, RTableCreate(kv, &rts, data.data(), bounds));
+    }
+
+    // Carrega pacotes com with(...) (ex.: "LinearAlgebra")
+    void preload(const std::vector<std::string>& packages)
+    {
+        for(const auto& pkg : packages)
+        {
+            executeCommand("with(" + pkg + "):");
+        }
+    }
+
+    // Resolve "Pkg:-Export" na primeira referência, sem with(): o
+    // Maple só carrega o módulo do pacote nesse momento. O ALGEB
+    // fica em cache (e protegido do GC) até o próximo restart().
+    //   ALGEB det = maple.require("LinearAlgebra:-Determinant");
+    //   EvalMapleProc(kv, det, 1, m);
+    ALGEB require(const std::string& name)
+    {
+        auto it = exports.find(name);
+        if(it != exports.end())
+            return it->second;
+
+        ALGEB f = executeCommand(name + ":");
+        if(f == nullptr || IsMapleNULL(kv, f))
+        {
+            throw std::runtime_error("require falhou: " + name + " ("
+                                     + getLastError() + ")");
+        }
+        MapleGcProtect(kv, f);
+        exports.emplace(name, f);
+        return f;
+    }
+
+    // require(name) + EvalMapleProc, com as mesmas conversões do
+    // PreparedStatement:
+    //   maple.call("LinearAlgebra:-Determinant", m);
+    template <typename... Args>
+    ALGEB call(const std::string& name, const Args&... args)
+    {
+        return EvalMapleProc(kv,
+                             require(name),
+                             static_cast<int>(sizeof...(Args)),
+                             PreparedStatement::toAlgeb(kv, args)...);
+    }
+
+    // Equivalente ao `restart` do Maple: limpa o estado do kernel
+    // sem encerrar o processo. O libname é reconfigurado e os
+    // exports de require() são resolvidos de novo no próximo uso.
+    void restart()
+    {
+        char err[2048];
+        // os handles protegidos só valem até o RestartMaple: solta
+        // tudo antes e recria depois
+        for(const auto& e : exports)
+            MapleGcAllow(kv, e.second);
+        exports.clear();
+        if(telemetry)
+            telemetry->detach();
+        if(rpcRegistry)
+            rpcRegistry->detach();
+        if(streamRegistry)
+            streamRegistry->detach();
+
+        bool ok = RestartMaple(kv, err);
+        // PreparedStatement/RTableView anteriores ficam inválidos
+        ++kernelGeneration();
+        if(telemetry)
+            telemetry->attach();
+        if(rpcRegistry)
+            rpcRegistry->attach();
+        if(streamRegistry)
+            streamRegistry->attach();
+        if(!ok)
+        {
+            throw std::runtime_error(
+                std::string("Falha no restart do Maple: ") + err);
+        }
+        configureLibname();
+    }
+
+    // Converte um resultado em texto (lprint-like)
+    std::string toString(ALGEB value)
+    {
+        if(value == nullptr || IsMapleNULL(kv, value))
+            return "";
+        ALGEB s = EvalMapleProc(kv,
+                                ToMapleName(kv, "convert", TRUE),
+                                2,
+                                value,
+                                ToMapleName(kv, "string", TRUE));
+        if(s == nullptr)
+            return "";
+        return MapleToString(kv, s);
+    }
+};
+
+#endif /* MAPLE_KERNEL_HPP */
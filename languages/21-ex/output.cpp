@@ -0,0 +1,119 @@
+/* output.cpp - textCallBack síncrono x OutputSink
+ *
+ * Roda o mesmo laço com printlevel := 6 (como no textCallBack.c do
+ * 19-ex) e imprime uma Matrix grande, primeiro com o textCallBack
+ * escrevendo direto no std::cout e depois com um OutputSink para
+ * cada política. O tempo medido é o do kernel (executeCommand); a
+ * drenagem continua em paralelo.
+ *
+ * ./output [N] [arquivo]   (padrão: N = 200, saída em output.log)
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "maple_kernel.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0)
+        .count();
+}
+
+static const char* policyName(OutputSink::Policy p)
+{
+    switch(p)
+    {
+    case OutputSink::Policy::Drop:
+        return "Drop";
+    case OutputSink::Policy::Block:
+        return "Block";
+    case OutputSink::Policy::Spill:
+        return "Spill";
+    }
+    return "?";
+}
+
+int main(int argc, char* argv[])
+{
+    const int         N    = argc > 1 ? std::atoi(argv[1]) : 200;
+    const std::string path = argc > 2 ? argv[2] : "output.log";
+
+    const std::string work
+        = "printlevel := 6: s := 0: for i to " + std::to_string(N)
+          + " do s := s + i^2 end do: printlevel := 1:"
+            " Matrix(60, 60, (i,j) -> i/j); s;";
+
+    try
+    {
+        MapleKernel maple{1, argv};
+        maple.executeCommand("interface(rtablesize = infinity):");
+
+        // --- 1. textCallBack direto no terminal ---
+        auto   t0        = Clock::now();
+        ALGEB  r         = maple.executeCommand(work);
+        double ms_direct = msSince(t0);
+
+        std::cout << "\n=== printlevel 6, N = " << N << " ===\n";
+        std::cout << "direto no std::cout: " << ms_direct << " ms ("
+                  << maple.toString(r) << ")\n";
+
+        // --- 2. OutputSink em arquivo, ring pequeno ---
+        for(auto policy : {OutputSink::Policy::Block,
+                           OutputSink::Policy::Spill,
+                           OutputSink::Policy::Drop})
+        {
+            maple.setOutputSink(std::make_unique<OutputSink>(
+                OutputSink::toFile(path), policy, 64 * 1024));
+
+            t0              = Clock::now();
+            r               = maple.executeCommand(work);
+            double ms_sink  = msSince(t0);
+            maple.getOutputSink()->flush();
+            double ms_total = msSince(t0);
+
+            auto st = maple.getOutputSink()->stats();
+            std::cout << "OutputSink " << policyName(policy) << ": "
+                      << ms_sink << " ms no kernel, " << ms_total
+                      << " ms até drenar (" << st.consumed
+                      << " registros, " << st.dropped
+                      << " descartados, " << st.spilled
+                      << " no spill, " << st.blocked
+                      << " esperas)\n";
+
+            // fecha o arquivo antes que o próximo sink o trunque
+            maple.setOutputSink(nullptr);
+        }
+        std::cout << "saída em " << path << "\n";
+
+        // --- 3. registro que não cabe antes do fim do ring ---
+        // 4 KiB: 2000 bytes, flush, e 3500 bytes com o ring vazio
+        for(auto policy : {OutputSink::Policy::Block,
+                           OutputSink::Policy::Drop,
+                           OutputSink::Policy::Spill})
+        {
+            size_t     bytes = 0;
+            OutputSink sink([&bytes](int, std::string_view s)
+                            { bytes += s.size(); },
+                            policy,
+                            4096);
+            sink.push(0, std::string(2000, 'a'));
+            sink.flush();
+            sink.push(0, std::string(3500, 'b'));
+            sink.flush();
+            std::cout << "volta no ring (" << policyName(policy)
+                      << "): " << bytes << " de 5500 bytes, "
+                      << sink.stats().dropped << " descartados\n";
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "\nFATAL EXCEPTION: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
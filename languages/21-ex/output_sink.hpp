@@ -0,0 +1,416 @@
+/* output_sink.hpp - Saída do textCallBack fora da thread do kernel
+ *
+ * O textCallBack dos exemplos escreve direto no terminal, na thread
+ * do kernel: com printlevel alto ou matrizes grandes o Maple fica
+ * parado esperando o I/O. O OutputSink só copia o texto (com o
+ * `tag`) para um ring buffer lock-free de um produtor (o kernel) e
+ * um consumidor (a thread de drenagem), que entrega cada registro
+ * ao Consumer: stdout, arquivo ou qualquer função.
+ *
+ * Quando o ring enche, vale a política escolhida:
+ *   Drop   descarta o registro (contado em stats().dropped)
+ *   Block  o kernel espera a drenagem liberar espaço
+ *   Spill  o registro vai para um arquivo temporário, lido pela
+ *          drenagem depois do ring; a ordem é preservada
+ *
+ * Registro no ring: len[4] + tag[4] + texto, alinhado a 8 bytes.
+ * len == WRAP indica que o resto do buffer até o fim foi pulado.
+ */
+
+#ifndef OUTPUT_SINK_HPP
+#define OUTPUT_SINK_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+class OutputSink
+{
+  public:
+    enum class Policy
+    {
+        Drop,
+        Block,
+        Spill
+    };
+
+    // Chamado só pela thread de drenagem, um registro por vez
+    using Consumer = std::function<void(int tag, std::string_view)>;
+
+    struct Stats
+    {
+        uint64_t pushed;    // aceitos (ring, spill ou direto)
+        uint64_t consumed;  // entregues ao Consumer
+        uint64_t dropped;   // descartados (Policy::Drop)
+        uint64_t spilled;   // gravados no arquivo de spill
+        uint64_t blocked;   // vezes que o kernel esperou (Block)
+    };
+
+    // Mesmo formato do textCallBack original
+    static Consumer toStream(std::ostream& os)
+    {
+        return [&os](int, std::string_view s)
+        { os << ">> Maple: " << s << "\n"; };
+    }
+
+    static Consumer toFile(const std::string& path)
+    {
+        auto f = std::make_shared<std::ofstream>(path);
+        if(!*f)
+            throw std::runtime_error("OutputSink: falha ao abrir "
+                                     + path);
+        return [f](int, std::string_view s)
+        {
+            f->write(s.data(),
+                     static_cast<std::streamsize>(s.size()));
+            f->put('\n');
+        };
+    }
+
+    // `capacity` é arredondada para potência de 2 (mínimo 4 KiB)
+    explicit OutputSink(Consumer c,
+                        Policy   p        = Policy::Block,
+                        size_t   capacity = size_t{1} << 20)
+        : consumer(std::move(c)), policy(p)
+    {
+        cap = 4096;
+        while(cap < capacity)
+            cap <<= 1;
+        mask = cap - 1;
+        buf.resize(cap);
+        drain = std::thread([this] { drainLoop(); });
+    }
+
+    // Entrega o que ainda estiver no ring/spill antes de sair
+    ~OutputSink()
+    {
+        stop.store(true);
+        wake.fetch_add(1);
+        wake.notify_one();
+        drain.join();
+        if(spillFile != nullptr)
+            std::fclose(spillFile);
+    }
+
+    OutputSink(const OutputSink&)            = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+    // Produtor: a thread do kernel (textCallBack). Uma só thread.
+    void push(int tag, std::string_view text)
+    {
+        if(text.size() >= WRAP - HDR)
+            text = text.substr(0, WRAP - HDR - 1);
+
+        if(policy == Policy::Spill && spillActive.load()
+           && spillWrite(tag, text, true))
+            return;
+        if(tryPush(tag, text))
+            return;
+
+        switch(policy)
+        {
+        case Policy::Drop:
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case Policy::Spill:
+            spillWrite(tag, text, false);
+            break;
+        case Policy::Block:
+            blockPush(tag, text);
+            break;
+        }
+    }
+
+    // Espera até que tudo o que foi aceito tenha sido entregue
+    void flush()
+    {
+        for(;;)
+        {
+            uint64_t c = consumed.load();
+            if(c >= pushed.load())
+                return;
+            consumed.wait(c);
+        }
+    }
+
+    Stats stats() const
+    {
+        return {pushed.load(),
+                consumed.load(),
+                dropped.load(),
+                spilled.load(),
+                blocked.load()};
+    }
+
+  private:
+    static constexpr uint32_t HDR  = 8;
+    static constexpr uint32_t WRAP = 0xFFFFFFFFu;
+
+    struct Header
+    {
+        uint32_t len;
+        int32_t  tag;
+    };
+
+    static uint64_t recordSize(size_t len)
+    {
+        return (HDR + len + 7) & ~uint64_t{7};
+    }
+
+    Consumer          consumer;
+    Policy            policy;
+    size_t            cap  = 0;
+    size_t            mask = 0;
+    std::vector<char> buf;
+
+    // posições absolutas em bytes; só crescem
+    std::atomic<uint64_t> head{0};  // escrita pelo produtor
+    std::atomic<uint64_t> tail{0};  // escrita pela drenagem
+
+    std::atomic<uint64_t> pushed{0};
+    std::atomic<uint64_t> consumed{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> spilled{0};
+    std::atomic<uint64_t> blocked{0};
+
+    // a drenagem dorme em `wake`; o produtor só notifica (syscall)
+    // quando `sleeping` está ligado
+    std::atomic<uint32_t> wake{0};
+    std::atomic<bool>     sleeping{false};
+    std::atomic<bool>     stop{false};
+
+    // spill: enquanto ativo, todo registro novo vai para o arquivo,
+    // de modo que o ring inteiro é anterior ao conteúdo do spill
+    std::mutex        spillMutex;
+    std::atomic<bool> spillActive{false};
+    std::FILE*        spillFile = nullptr;
+    off_t             spillRead = 0, spillWritten = 0;
+
+    std::thread drain;
+
+    void wakeDrain()
+    {
+        if(sleeping.load())
+        {
+            wake.fetch_add(1);
+            wake.notify_one();
+        }
+    }
+
+    bool tryPush(int tag, std::string_view text)
+    {
+        uint64_t rec = recordSize(text.size());
+        if(rec > cap)
+            return false;
+
+        uint64_t h      = head.load(std::memory_order_relaxed);
+        uint64_t t      = tail.load(std::memory_order_acquire);
+        size_t   off    = h & mask;
+        size_t   to_end = cap - off;
+
+        if(rec <= to_end)
+        {
+            if(cap - (h - t) < rec)
+                return false;
+        }
+        else if(h == t)
+        {
+            // ring vazio e a drenagem parada: em vez do marcador WRAP
+            // (que o registro poderia sobrescrever), as duas posições
+            // pulam para o início do buffer
+            h += to_end;
+            tail.store(h, std::memory_order_release);
+            off = 0;
+        }
+        else
+        {
+            // com registros pendentes só cabe depois do WRAP; se nem
+            // assim couber, espera o ring esvaziar
+            if(cap - (h - t) < to_end + rec)
+                return false;
+            Header wrap = {WRAP, 0};
+            std::memcpy(&buf[off], &wrap, HDR);
+            h += to_end;
+            off = 0;
+        }
+        Header hd = {static_cast<uint32_t>(text.size()), tag};
+        std::memcpy(&buf[off], &hd, HDR);
+        std::memcpy(&buf[off + HDR], text.data(), text.size());
+
+        pushed.fetch_add(1, std::memory_order_relaxed);
+        head.store(h + rec);
+        wakeDrain();
+        return true;
+    }
+
+    void blockPush(int tag, std::string_view text)
+    {
+        blocked.fetch_add(1, std::memory_order_relaxed);
+        if(recordSize(text.size()) <= cap)
+        {
+            for(;;)
+            {
+                uint64_t c = consumed.load();
+                if(tryPush(tag, text))
+                    return;
+                if(c >= pushed.load())
+                    break;  // ring vazio e ainda assim não coube
+                consumed.wait(c);
+            }
+        }
+
+        // maior que o ring (ou sem como caber): espera esvaziar e
+        // entrega direto
+        flush();
+        pushed.fetch_add(1);
+        deliver(tag, text);
+        markConsumed();
+    }
+
+    bool spillWrite(int              tag,
+                    std::string_view text,
+                    bool             onlyIfActive)
+    {
+        std::lock_guard<std::mutex> lock(spillMutex);
+        if(onlyIfActive && !spillActive.load())
+            return false;
+        if(spillFile == nullptr
+           && (spillFile = std::tmpfile()) == nullptr)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        int    fd = fileno(spillFile);
+        Header hd = {static_cast<uint32_t>(text.size()), tag};
+        if(pwrite(fd, &hd, HDR, spillWritten) != HDR
+           || pwrite(fd,
+                     text.data(),
+                     text.size(),
+                     spillWritten + HDR)
+                  != static_cast<ssize_t>(text.size()))
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        spillWritten += HDR + static_cast<off_t>(text.size());
+        spilled.fetch_add(1, std::memory_order_relaxed);
+        pushed.fetch_add(1, std::memory_order_relaxed);
+        spillActive.store(true);
+        wakeDrain();
+        return true;
+    }
+
+    // Lê um registro do spill; false se já estava vazio
+    bool spillReadOne(int& tag, std::string& text)
+    {
+        std::lock_guard<std::mutex> lock(spillMutex);
+        if(!spillActive.load())
+            return false;
+
+        int    fd = fileno(spillFile);
+        Header hd;
+        if(pread(fd, &hd, HDR, spillRead) != HDR)
+            hd.len = 0;
+        text.resize(hd.len);
+        if(hd.len > 0
+           && pread(fd, &text[0], hd.len, spillRead + HDR)
+                  != static_cast<ssize_t>(hd.len))
+            text.clear();
+        tag = hd.tag;
+        spillRead += HDR + static_cast<off_t>(hd.len);
+
+        if(spillRead >= spillWritten)
+        {
+            if(ftruncate(fd, 0) != 0)
+            {
+                // segue escrevendo do início; só não encolhe
+            }
+            spillRead = spillWritten = 0;
+            spillActive.store(false);
+        }
+        return true;
+    }
+
+    void deliver(int tag, std::string_view text)
+    {
+        try
+        {
+            consumer(tag, text);
+        }
+        catch(...)
+        {
+            // um Consumer com erro não pode derrubar a drenagem
+        }
+    }
+
+    // Depois de avançar `tail`: quem espera em Block/flush acorda
+    // já vendo o espaço liberado
+    void markConsumed()
+    {
+        consumed.fetch_add(1);
+        consumed.notify_all();
+    }
+
+    void drainLoop()
+    {
+        std::string spillText;
+        for(;;)
+        {
+            // head antes de tail: com o ring vazio o produtor pode
+            // realinhar `tail` (ver tryPush) antes de publicar `head`
+            uint64_t h = head.load(std::memory_order_acquire);
+            uint64_t t = tail.load(std::memory_order_acquire);
+            if(t < h)
+            {
+                size_t off = t & mask;
+                Header hd;
+                std::memcpy(&hd, &buf[off], HDR);
+                if(hd.len == WRAP)
+                {
+                    t += cap - off;
+                    tail.store(t, std::memory_order_release);
+                    continue;
+                }
+                deliver(hd.tag,
+                        std::string_view(&buf[off + HDR], hd.len));
+                t += recordSize(hd.len);
+                tail.store(t, std::memory_order_release);
+                markConsumed();
+                continue;
+            }
+
+            int tag;
+            if(spillReadOne(tag, spillText))
+            {
+                deliver(tag, spillText);
+                markConsumed();
+                continue;
+            }
+
+            uint32_t w = wake.load();
+            sleeping.store(true);
+            if(tail.load() >= head.load() && !spillActive.load())
+            {
+                if(stop.load())
+                    break;
+                wake.wait(w);
+            }
+            sleeping.store(false);
+        }
+    }
+};
+
+#endif /* OUTPUT_SINK_HPP */
@@ -0,0 +1,83 @@
+/* prepared.cpp - Micro-benchmark: executeCommand(std::string) x
+ * MapleKernel::prepare()
+ *
+ * Avalia a derivada df em N pontos de três formas:
+ *   1. sprintf + parser a cada chamada (como em 10-ex/11-ex)
+ *   2. PreparedStatement  ->  EvalMapleProc
+ *   3. PreparedStatement  ->  EvalhfMapleProc
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "maple_kernel.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0)
+        .count();
+}
+
+int main(int argc, char* argv[])
+{
+    const int N = argc > 1 ? std::atoi(argv[1]) : 10000;
+
+    try
+    {
+        MapleKernel   maple{1, argv};
+        MKernelVector kv = maple.getKernelVector();
+
+        maple.executeCommand("df := diff(sin(x)*exp(-x^2/4), x):");
+
+        // --- 1. string + parser por chamada ---
+        double sum_str = 0.0;
+        auto   t0      = Clock::now();
+        for(int i = 0; i < N; ++i)
+        {
+            double x = -5.0 + 10.0 * i / N;
+            ALGEB  r = maple.executeCommand(
+                "evalf(eval(df, x = " + std::to_string(x) + ")):");
+            sum_str += MapleToFloat64(kv, r);
+        }
+        double ms_str = msSince(t0);
+
+        // --- 2. prepared + EvalMapleProc ---
+        PreparedStatement at = maple.prepare("evalf(eval(df, x = ?))");
+        double            sum_proc = 0.0;
+        t0                         = Clock::now();
+        for(int i = 0; i < N; ++i)
+        {
+            double x = -5.0 + 10.0 * i / N;
+            sum_proc += MapleToFloat64(kv, at(x));
+        }
+        double ms_proc = msSince(t0);
+
+        // --- 3. prepared + EvalhfMapleProc ---
+        PreparedStatement f   = maple.prepare("eval(df, x = ?)");
+        double            sum_hf = 0.0;
+        t0                       = Clock::now();
+        for(int i = 0; i < N; ++i)
+        {
+            double x = -5.0 + 10.0 * i / N;
+            sum_hf += f.evalhf(x);
+        }
+        double ms_hf = msSince(t0);
+
+        std::cout << "\n=== " << N << " avaliações de df ===\n";
+        std::cout << "executeCommand(string): " << ms_str << " ms"
+                  << "  (soma " << sum_str << ")\n";
+        std::cout << "prepare + EvalMapleProc: " << ms_proc << " ms"
+                  << "  (soma " << sum_proc << ")\n";
+        std::cout << "prepare + evalhf:        " << ms_hf << " ms"
+                  << "  (soma " << sum_hf << ")\n";
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "\nFATAL EXCEPTION: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
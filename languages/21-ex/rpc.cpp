@@ -0,0 +1,80 @@
+/* rpc.cpp - callback() em texto x handlers registrados (RpcRegistry)
+ *
+ * O Maple chama uma função C++ N vezes num laço:
+ *   1. como no 19-ex: callback(i) com o argumento em texto, resposta
+ *      em código Maple ("<valor>;") analisada de novo pelo kernel
+ *   2. maple.rpc().add("sq", ...): argumento e resultado como ALGEB
+ *
+ * ./rpc [N]   (padrão: 10^6)
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "maple_kernel.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0)
+        .count();
+}
+
+int main(int argc, char* argv[])
+{
+    const long        N = argc > 1 ? std::atol(argv[1]) : 1000000;
+    const std::string n = std::to_string(N);
+
+    try
+    {
+        MapleKernel  maple{1, argv};
+        RpcRegistry& rpc = maple.rpc();
+
+        // --- 1. texto nos dois sentidos (19-ex) ---
+        rpc.setFallback(
+            [](std::string_view args)
+            {
+                double x = std::strtod(std::string(args).c_str(),
+                                       nullptr);
+                return std::to_string(x * x) + ";";
+            });
+        auto  t0 = Clock::now();
+        ALGEB r
+            = maple.executeCommand("add(callback(i), i = 1.." + n + ");");
+        double      ms_text = msSince(t0);
+        std::string s_text  = maple.toString(r);
+
+        // --- 2. handler tipado ---
+        rpc.add("sq", [](double x) { return x * x; });
+        rpc.add("clamp",
+                [](long v, long lo, long hi)
+                { return v < lo ? lo : v > hi ? hi : v; });
+        rpc.add("greet",
+                [](const std::string& who) { return "olá, " + who; });
+
+        t0 = Clock::now();
+        r  = maple.executeCommand("add(sq(i), i = 1.." + n + ");");
+        double      ms_rpc = msSince(t0);
+        std::string s_rpc  = maple.toString(r);
+
+        std::cout << "\n=== " << N << " chamadas Maple -> C++ ===\n";
+        std::cout << "callback(i) em texto: " << ms_text << " ms ("
+                  << s_text << ")\n";
+        std::cout << "rpc sq(i):            " << ms_rpc << " ms ("
+                  << s_rpc << ")\n";
+
+        std::cout << maple.toString(maple.executeCommand(
+                         "[clamp(15, 0, 10), greet(\"Maple\")];"))
+                  << "\n";
+        maple.executeCommand("sq(\"x\");");  // erro: tipo errado
+        std::cout << "erro esperado: " << maple.getLastError() << "\n";
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "\nFATAL EXCEPTION: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,351 @@
+/* rpc.hpp - Handlers C++ chamados pelo Maple via callBackCallBack
+ *
+ * No 19-ex/callBackCallBack.c o Maple chama callback(...) com os
+ * argumentos convertidos em texto; o C os analisa com sscanf/strcmp
+ * e devolve código Maple em texto, que o kernel analisa de novo.
+ *
+ * O RpcRegistry registra handlers com nome e tipos:
+ *
+ *   rpc.add("sq", [](double x) { return x * x; });
+ *   maple.executeCommand("add(sq(i), i = 1..10^6);");
+ *
+ * add() define no Maple o procedimento
+ *   sq := proc() global _rpc_args, _rpc_ret;
+ *             _rpc_args := [_passed]; callback("rpc:sq");
+ *             eval(_rpc_ret, 1) end proc
+ * O callBackCallBack recebe só o nome, acha o handler numa tabela
+ * hash, lê os argumentos do global _rpc_args (ALGEBs, sem texto),
+ * converte para os tipos do handler e grava o resultado em _rpc_ret
+ * com MapleAssign. No caminho normal nada passa pelo parser; só em
+ * caso de erro o callback devolve `error "..."` para o Maple.
+ *
+ * Tipos aceitos nos argumentos e no retorno: double, float, int,
+ * long, bool, std::string e ALGEB (sem conversão); void no retorno.
+ */
+
+#ifndef RPC_HPP
+#define RPC_HPP
+
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include "maplec.h"
+
+// ===========================================
+// CONVERSÃO DE TIPOS
+// ===========================================
+
+template <typename T>
+struct RpcType;
+
+template <>
+struct RpcType<ALGEB>
+{
+    static constexpr const char* name = "anything";
+    static bool check(MKernelVector, ALGEB)
+    {
+        return true;
+    }
+    static ALGEB from(MKernelVector, ALGEB a)
+    {
+        return a;
+    }
+    static ALGEB to(MKernelVector, ALGEB a)
+    {
+        return a;
+    }
+};
+
+template <>
+struct RpcType<double>
+{
+    static constexpr const char* name = "numeric";
+    static bool check(MKernelVector k, ALGEB a)
+    {
+        return IsMapleNumeric(k, a);
+    }
+    static double from(MKernelVector k, ALGEB a)
+    {
+        return MapleToFloat64(k, a);
+    }
+    static ALGEB to(MKernelVector k, double d)
+    {
+        return ToMapleFloat(k, d);
+    }
+};
+
+template <>
+struct RpcType<float> : RpcType<double>
+{
+    static float from(MKernelVector k, ALGEB a)
+    {
+        return static_cast<float>(MapleToFloat64(k, a));
+    }
+};
+
+template <>
+struct RpcType<long>
+{
+    static constexpr const char* name = "integer";
+    static bool check(MKernelVector k, ALGEB a)
+    {
+        return IsMapleInteger(k, a);
+    }
+    static long from(MKernelVector k, ALGEB a)
+    {
+        return static_cast<long>(MapleToInteger64(k, a));
+    }
+    static ALGEB to(MKernelVector k, long i)
+    {
+        return ToMapleInteger(k, i);
+    }
+};
+
+template <>
+struct RpcType<int> : RpcType<long>
+{
+    static int from(MKernelVector k, ALGEB a)
+    {
+        return MapleToInteger32(k, a);
+    }
+};
+
+template <>
+struct RpcType<bool>
+{
+    static constexpr const char* name = "truefalse";
+    // só os nomes true e false: qualquer outro nome faria o
+    // MapleToM_BOOL levantar erro no kernel em vez do erro tipado
+    static bool check(MKernelVector k, ALGEB a)
+    {
+        return IsMapleName(k, a)
+               && (MapleEqual(k, a, ToMapleBoolean(k, TRUE))
+                   || MapleEqual(k, a, ToMapleBoolean(k, FALSE)));
+    }
+    static bool from(MKernelVector k, ALGEB a)
+    {
+        return MapleToM_BOOL(k, a) != FALSE;
+    }
+    static ALGEB to(MKernelVector k, bool b)
+    {
+        return ToMapleBoolean(k, b ? TRUE : FALSE);
+    }
+};
+
+template <>
+struct RpcType<std::string>
+{
+    static constexpr const char* name = "string";
+    static bool check(MKernelVector k, ALGEB a)
+    {
+        return IsMapleString(k, a);
+    }
+    static std::string from(MKernelVector k, ALGEB a)
+    {
+        return MapleToString(k, a);
+    }
+    static ALGEB to(MKernelVector k, const std::string& s)
+    {
+        return ToMapleString(k, s.c_str());
+    }
+};
+
+// ===========================================
+// REGISTRO DE HANDLERS
+// ===========================================
+
+class RpcRegistry
+{
+  public:
+    // Recebe a lista de argumentos; devolve o resultado ou lança
+    // std::exception (vira `error` no Maple)
+    using Handler = std::function<ALGEB(MKernelVector, ALGEB)>;
+
+    explicit RpcRegistry(MKernelVector k) : kv(k)
+    {
+        attach();
+    }
+
+    ~RpcRegistry()
+    {
+        detach();
+    }
+
+    RpcRegistry(const RpcRegistry&)            = delete;
+    RpcRegistry& operator=(const RpcRegistry&) = delete;
+
+    // Handler tipado: os argumentos são conferidos e convertidos
+    // conforme a assinatura de `fn`
+    template <typename F>
+    void add(const std::string& name, F fn)
+    {
+        addRaw(name, wrap(std::function(std::move(fn))));
+    }
+
+    // Handler sem conversão: recebe a lista [_passed]
+    void addRaw(const std::string& name, Handler h)
+    {
+        handlers[name] = std::move(h);
+        define(name);
+    }
+
+    // callback(...) que não vem de um handler registrado (como o
+    // callback(i) do 19-ex): devolve código Maple em texto ou ""
+    void setFallback(std::function<std::string(std::string_view)> f)
+    {
+        fallback = std::move(f);
+    }
+
+    // Globais e procedimentos somem no RestartMaple: recria tudo
+    void attach()
+    {
+        argsName = ToMapleName(kv, "_rpc_args", TRUE);
+        retName  = ToMapleName(kv, "_rpc_ret", TRUE);
+        MapleGcProtect(kv, argsName);
+        MapleGcProtect(kv, retName);
+        for(const auto& h : handlers)
+            define(h.first);
+    }
+
+    // Solta os nomes globais; chamar antes do RestartMaple
+    void detach()
+    {
+        if(argsName != nullptr)
+            MapleGcAllow(kv, argsName);
+        if(retName != nullptr)
+            MapleGcAllow(kv, retName);
+        argsName = retName = nullptr;
+    }
+
+    // Chamado pelo callBackCallBack do MapleKernel
+    char* dispatch(const char* args)
+    {
+        std::string_view a(args);
+        if(a.size() >= 2 && a.front() == '"' && a.back() == '"')
+            a = a.substr(1, a.size() - 2);
+
+        if(a.substr(0, 4) != "rpc:")
+        {
+            reply = fallback ? fallback(a) : std::string();
+            return reply.empty() ? nullptr : &reply[0];
+        }
+
+        auto it = handlers.find(a.substr(4));
+        if(it == handlers.end())
+        {
+            return raise("rpc: handler desconhecido "
+                         + std::string(a));
+        }
+
+        try
+        {
+            ALGEB r = it->second(kv, MapleEval(kv, argsName));
+            MapleAssign(
+                kv, retName, r != nullptr ? r : ToMapleNULL(kv));
+            return nullptr;
+        }
+        catch(const std::exception& e)
+        {
+            return raise(std::string(a.substr(4)) + ": " + e.what());
+        }
+    }
+
+  private:
+    // std::string_view como chave de busca, sem alocar
+    struct NameHash
+    {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const
+        {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+
+    MKernelVector kv;
+    ALGEB         argsName = nullptr;
+    ALGEB         retName  = nullptr;
+    std::string   reply;
+
+    using HandlerTable = std::unordered_map<std::string,
+                                            Handler,
+                                            NameHash,
+                                            std::equal_to<>>;
+
+    HandlerTable                                  handlers;
+    std::function<std::string(std::string_view)> fallback;
+
+    void define(const std::string& name)
+    {
+        std::string src = name
+                          + " := proc() global _rpc_args, _rpc_ret;"
+                            " _rpc_args := [_passed]; callback(\"rpc:"
+                          + name + "\"); eval(_rpc_ret, 1) end proc:";
+        if(EvalMapleStatement(kv, src.c_str()) == nullptr)
+            throw std::runtime_error("rpc: falha ao definir " + name);
+    }
+
+    // `error "msg"` é analisado e avaliado pelo kernel no lugar da
+    // chamada callback(...)
+    char* raise(const std::string& msg)
+    {
+        reply = "error \"";
+        for(char c : msg)
+        {
+            if(c == '"' || c == '\\')
+                reply += '\\';
+            reply += c;
+        }
+        reply += "\";";
+        return &reply[0];
+    }
+
+    template <typename R, typename... Args, size_t... I>
+    static ALGEB call(const std::function<R(Args...)>& fn,
+                      MKernelVector                    k,
+                      ALGEB                            list,
+                      std::index_sequence<I...>)
+    {
+        ALGEB a[] = {nullptr, MapleListSelect(k, list, I + 1)...};
+        ((RpcType<std::decay_t<Args>>::check(k, a[I + 1])
+              ? void()
+              : throw std::invalid_argument(
+                  "argumento " + std::to_string(I + 1)
+                  + " deveria ser "
+                  + RpcType<std::decay_t<Args>>::name)),
+         ...);
+        if constexpr(std::is_void_v<R>)
+        {
+            fn(RpcType<std::decay_t<Args>>::from(k, a[I + 1])...);
+            return nullptr;
+        }
+        else
+        {
+            return RpcType<std::decay_t<R>>::to(
+                k, fn(RpcType<std::decay_t<Args>>::from(k, a[I + 1])...));
+        }
+    }
+
+    template <typename R, typename... Args>
+    static Handler wrap(std::function<R(Args...)> fn)
+    {
+        return [fn = std::move(fn)](MKernelVector k, ALGEB list)
+        {
+            if(MapleNumArgs(k, list)
+               != static_cast<M_INT>(sizeof...(Args)))
+            {
+                throw std::invalid_argument(
+                    "esperava " + std::to_string(sizeof...(Args))
+                    + " argumento(s)");
+            }
+            return call(fn, k, list, std::index_sequence_for<Args...>{});
+        };
+    }
+};
+
+#endif /* RPC_HPP */
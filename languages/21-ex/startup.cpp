@@ -0,0 +1,254 @@
+/* startup.cpp - Onde vai o tempo de partida do kernel
+ *
+ * Mede, N vezes, cada fase de uma partida a frio: StartMaple,
+ * libname (LibnameResolver + atribuição), with(...) de cada pacote
+ * e a primeira avaliação. O OpenMaple só permite um StartMaple por
+ * processo, então cada repetição roda num filho (fork) que devolve
+ * os tempos ao pai por um pipe.
+ *
+ * Os with(...) são medidos na ordem da lista: cada um paga apenas o
+ * que os anteriores ainda não carregaram.
+ *
+ * ./startup [N] [saida.json]   (padrão: 20, startup.json)
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "maplec.h"
+#include "libname.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0)
+        .count();
+}
+
+static const std::vector<std::string> packages = {"LinearAlgebra",
+                                                  "plots",
+                                                  "VectorCalculus",
+                                                  "Optimization",
+                                                  "CurveFitting"};
+
+static const char* firstEval = "int(1/(x^4+1), x):";
+
+static std::vector<std::string> phaseNames()
+{
+    std::vector<std::string> names = {"StartMaple", "libname"};
+    for(const auto& p : packages)
+        names.push_back("with(" + p + ")");
+    names.push_back("primeiro resultado");
+    names.push_back("total");
+    return names;
+}
+
+// Saída do kernel descartada: só interessa o tempo
+static void M_DECL textCallBack(void*, int, const char*)
+{
+}
+
+static void M_DECL errorCallBack(void*, M_INT, const char* msg)
+{
+    std::cerr << "startup: " << msg << "\n";
+}
+
+// Filho: uma partida completa, tempos em `fd`, e sai
+[[noreturn]] static void measure(int fd, char* argv0)
+{
+    std::vector<double> t;
+    char                err[2048];
+    char*               args[] = {argv0, nullptr};
+    MCallBackVectorDesc cb     = {textCallBack,
+                                  errorCallBack,
+                                  nullptr,
+                                  nullptr,
+                                  nullptr,
+                                  nullptr,
+                                  nullptr,
+                                  nullptr};
+
+    auto start = Clock::now();
+    auto t0    = start;
+    MKernelVector kv = StartMaple(1, args, &cb, nullptr, nullptr, err);
+    if(kv == nullptr)
+    {
+        std::cerr << "startup: StartMaple falhou: " << err << "\n";
+        _exit(1);
+    }
+    t.push_back(msSince(t0));
+
+    t0 = Clock::now();
+    const auto& dirs = LibnameResolver::paths();
+    std::string lib  = LibnameResolver::statement(
+        dirs.empty() ? std::vector<std::string>{"/opt/maple2021/lib"}
+                      : dirs);
+    EvalMapleStatement(kv, lib.c_str());
+    t.push_back(msSince(t0));
+
+    for(const auto& p : packages)
+    {
+        t0 = Clock::now();
+        if(EvalMapleStatement(kv, ("with(" + p + "):").c_str())
+           == nullptr)
+            _exit(1);
+        t.push_back(msSince(t0));
+    }
+
+    t0 = Clock::now();
+    if(EvalMapleStatement(kv, firstEval) == nullptr)
+        _exit(1);
+    t.push_back(msSince(t0));
+    t.push_back(msSince(start));
+
+    size_t len = t.size() * sizeof(double);
+    _exit(write(fd, t.data(), len) == static_cast<ssize_t>(len) ? 0
+                                                                 : 1);
+}
+
+static std::vector<double> runOnce(char* argv0, size_t phases)
+{
+    int p[2];
+    if(pipe(p) != 0)
+        throw std::runtime_error("pipe falhou");
+
+    std::cout.flush();
+    std::cerr.flush();
+    pid_t pid = fork();
+    if(pid < 0)
+        throw std::runtime_error("fork falhou");
+    if(pid == 0)
+    {
+        close(p[0]);
+        measure(p[1], argv0);
+    }
+    close(p[1]);
+
+    std::vector<double> t(phases);
+    char*               dst  = reinterpret_cast<char*>(t.data());
+    size_t              left = phases * sizeof(double);
+    while(left > 0)
+    {
+        ssize_t n = read(p[0], dst, left);
+        if(n <= 0)
+            break;
+        dst += n;
+        left -= static_cast<size_t>(n);
+    }
+    close(p[0]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if(left > 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        throw std::runtime_error("repetição falhou no filho");
+    return t;
+}
+
+struct Summary
+{
+    double min, p50, p90, p99, max, mean;
+};
+
+// Percentil pelo posto mais próximo
+static double percentile(const std::vector<double>& sorted, double q)
+{
+    size_t rank = static_cast<size_t>(
+        std::ceil(q / 100.0 * static_cast<double>(sorted.size())));
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+static Summary summarize(std::vector<double> v)
+{
+    std::sort(v.begin(), v.end());
+    double sum = 0;
+    for(double x : v)
+        sum += x;
+    return {v.front(),
+            percentile(v, 50),
+            percentile(v, 90),
+            percentile(v, 99),
+            v.back(),
+            sum / static_cast<double>(v.size())};
+}
+
+static void writeJson(const std::string&                      path,
+                      const std::vector<std::string>&         names,
+                      const std::vector<std::vector<double>>& samples)
+{
+    std::ofstream f(path);
+    f << std::setprecision(6) << "{\n  \"repetitions\": "
+      << samples.front().size() << ",\n  \"first_eval\": \""
+      << firstEval << "\",\n  \"unit\": \"ms\",\n  \"phases\": [";
+    for(size_t i = 0; i < names.size(); ++i)
+    {
+        Summary s = summarize(samples[i]);
+        f << (i ? "," : "") << "\n    {\"name\": \"" << names[i]
+          << "\", \"min\": " << s.min << ", \"p50\": " << s.p50
+          << ", \"p90\": " << s.p90 << ", \"p99\": " << s.p99
+          << ", \"max\": " << s.max << ", \"mean\": " << s.mean
+          << ",\n     \"samples\": [";
+        for(size_t j = 0; j < samples[i].size(); ++j)
+            f << (j ? ", " : "") << samples[i][j];
+        f << "]}";
+    }
+    f << "\n  ]\n}\n";
+}
+
+int main(int argc, char* argv[])
+{
+    const int         N    = argc > 1 ? std::atoi(argv[1]) : 20;
+    const std::string json = argc > 2 ? argv[2] : "startup.json";
+
+    try
+    {
+        if(N <= 0)
+            throw std::invalid_argument("N deve ser positivo");
+
+        auto names = phaseNames();
+        std::vector<std::vector<double>> samples(names.size());
+        for(int r = 0; r < N; ++r)
+        {
+            auto t = runOnce(argv[0], names.size());
+            for(size_t i = 0; i < t.size(); ++i)
+                samples[i].push_back(t[i]);
+            std::cout << "\rrepetição " << r + 1 << "/" << N
+                      << std::flush;
+        }
+
+        std::cout << "\n\n=== Partida a frio, " << N
+                  << " repetições (ms) ===\n"
+                  << std::left << std::setw(24) << "fase" << std::right
+                  << std::setw(10) << "p50" << std::setw(10) << "p90"
+                  << std::setw(10) << "p99" << std::setw(10) << "max"
+                  << "\n"
+                  << std::fixed << std::setprecision(1);
+        for(size_t i = 0; i < names.size(); ++i)
+        {
+            Summary s = summarize(samples[i]);
+            std::cout << std::left << std::setw(24) << names[i]
+                      << std::right << std::setw(10) << s.p50
+                      << std::setw(10) << s.p90 << std::setw(10)
+                      << s.p99 << std::setw(10) << s.max << "\n";
+        }
+
+        writeJson(json, names, samples);
+        std::cout << "JSON: " << json << "\n";
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "\nFATAL EXCEPTION: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+/* streams.cpp - streamCallBack com StreamRegistry
+ *
+ * O pacote `app` do 19-ex/streamCallBack.c (version, help, test),
+ * agora com handlers registrados, e um stream numérico em bloco:
+ * o Maple entrega um Vector de N floats ao C++ de duas formas:
+ *   1. streamcall com os N valores como argumentos (texto)
+ *   2. addBulk: std::span<const double> sobre o RTable, sem texto
+ *
+ * ./streams [N]   (padrão: 10^5)
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include "maple_kernel.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0)
+        .count();
+}
+
+int main(int argc, char* argv[])
+{
+    const long        N = argc > 1 ? std::atol(argv[1]) : 100000;
+    const std::string n = std::to_string(N);
+
+    try
+    {
+        MapleKernel     maple{1, argv};
+        StreamRegistry& streams = maple.streams();
+
+        // --- pacote app do 19-ex ---
+        streams.add("app_version",
+                    [](StreamRegistry::Args, std::string& r)
+                    { r = "1.1;"; });
+        streams.add("app_help",
+                    [](StreamRegistry::Args a, std::string&)
+                    {
+                        if(a.empty())
+                            std::cout << "Error, unspecified topic\n";
+                        else if(a[0] == "test")
+                            std::cout << "Usage: test(args)\n"
+                                         "       - displays args in "
+                                         "reverse order\n";
+                        else
+                            std::cout << "unrecognized topic " << a[0]
+                                      << "\n";
+                    });
+        streams.add("app_test",
+                    [](StreamRegistry::Args a, std::string& r)
+                    {
+                        for(size_t i = a.size(); i-- > 0;)
+                            std::cout << "args[" << i << "] = " << a[i]
+                                      << "\n";
+                        r = std::to_string(a.size()) + ";";
+                    });
+
+        maple.executeCommand(
+            "app := module() export help, test, version; "
+            "help := proc(topic) streamcall(INTERFACE_app_help(topic)) "
+            "end; "
+            "version := proc() streamcall(INTERFACE_app_version()) end; "
+            "test := proc() streamcall(INTERFACE_app_test(args)) end; "
+            "end module:");
+        maple.executeCommand("with(app):");
+        maple.executeCommand("version();");
+        maple.executeCommand("help(test);");
+        maple.executeCommand("test(1,2,3,4);");
+
+        // --- 1. N floats como argumentos em texto ---
+        double sum_text = 0.0;
+        streams.add("sum_text",
+                    [&](StreamRegistry::Args a, std::string&)
+                    {
+                        for(auto s : a)
+                            sum_text += std::strtod(s.data(), nullptr);
+                    });
+        maple.executeCommand("V := Vector(" + n
+                             + ", i -> evalf(sin(i)), "
+                               "datatype = float[8]):");
+        auto t0 = Clock::now();
+        maple.executeCommand(
+            "streamcall(INTERFACE_sum_text(seq(V))):");
+        double ms_text = msSince(t0);
+
+        // --- 2. stream em bloco ---
+        double sum_bulk = 0.0;
+        streams.addBulk("sum_bulk",
+                        [&](std::span<const double> v,
+                            StreamRegistry::Args,
+                            std::string&)
+                        {
+                            sum_bulk
+                                = std::accumulate(v.begin(), v.end(), 0.0);
+                        });
+        t0 = Clock::now();
+        maple.executeCommand("sum_bulk(V):");
+        double ms_bulk = msSince(t0);
+
+        std::cout << "\n=== Vector de " << N << " floats -> C++ ===\n";
+        std::cout << "streamcall em texto: " << ms_text << " ms (soma "
+                  << sum_text << ")\n";
+        std::cout << "addBulk (span):      " << ms_bulk << " ms (soma "
+                  << sum_bulk << ")\n";
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "\nFATAL EXCEPTION: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
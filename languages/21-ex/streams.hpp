@@ -0,0 +1,200 @@
+/* streams.hpp - Registro de streams para o streamCallBack
+ *
+ * No 19-ex/streamCallBack.c o streamCallBack escolhe o handler com
+ * uma cadeia de strcmp e cada handler devolve um buffer estático.
+ * O StreamRegistry acha o handler numa tabela hash e entrega:
+ *
+ *   add("app_test", [](StreamRegistry::Args a, std::string& r)
+ *       { r = std::to_string(a.size()) + ";"; });
+ *
+ * - os argumentos como std::span<const std::string_view> (sem
+ *   copiar os char** do kernel);
+ * - `r`, um buffer do próprio registro, reaproveitado entre as
+ *   chamadas: o ponteiro devolvido ao kernel é o dele (vazio = NULL).
+ *
+ * Streams numéricos em bloco (addBulk) não imprimem os dados: o
+ * procedimento Maple com o nome do stream guarda o Vector float[8]
+ * no global _stream_data e o handler recebe um std::span<const
+ * double> sobre o próprio RTableDataBlock.
+ *
+ *   streams.addBulk("consume", [](std::span<const double> v,
+ *                                 StreamRegistry::Args, std::string&)
+ *                   { ... });
+ *   maple.executeCommand("consume(Vector(10^6, i -> sin(i)));");
+ */
+
+#ifndef STREAMS_HPP
+#define STREAMS_HPP
+
+#include <cstring>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "maplec.h"
+
+class StreamRegistry
+{
+  public:
+    using Args    = std::span<const std::string_view>;
+    using Handler = std::function<void(Args, std::string& reply)>;
+    using BulkHandler
+        = std::function<void(std::span<const double>, Args, std::string&)>;
+
+    explicit StreamRegistry(MKernelVector k) : kv(k)
+    {
+        attach();
+    }
+
+    ~StreamRegistry()
+    {
+        detach();
+    }
+
+    StreamRegistry(const StreamRegistry&)            = delete;
+    StreamRegistry& operator=(const StreamRegistry&) = delete;
+
+    // streamcall(INTERFACE_name(...)) no Maple chama `h`
+    void add(const std::string& name, Handler h)
+    {
+        handlers[name] = {std::move(h), nullptr};
+    }
+
+    // Define também o procedimento Maple name(V, ...): V (Vector,
+    // Matrix ou lista) vai como float[8], sem passar por texto
+    void addBulk(const std::string& name, BulkHandler h)
+    {
+        handlers[name] = {nullptr, std::move(h)};
+        define(name);
+    }
+
+    // Procedimentos e globais somem no RestartMaple: recria
+    void attach()
+    {
+        dataName = ToMapleName(kv, "_stream_data", TRUE);
+        MapleGcProtect(kv, dataName);
+        for(const auto& h : handlers)
+        {
+            if(h.second.bulk)
+                define(h.first);
+        }
+    }
+
+    // Solta _stream_data; chamar antes do RestartMaple
+    void detach()
+    {
+        if(dataName != nullptr)
+            MapleGcAllow(kv, dataName);
+        dataName = nullptr;
+    }
+
+    // Chamado pelo streamCallBack do MapleKernel
+    char* dispatch(const char* name, M_INT nargs, char** args)
+    {
+        auto it = handlers.find(std::string_view(name));
+        if(it == handlers.end())
+            return raise("stream desconhecido: " + std::string(name));
+
+        argv.clear();
+        for(M_INT i = 0; i < nargs; ++i)
+            argv.emplace_back(args[i]);
+        reply.clear();
+
+        try
+        {
+            if(it->second.bulk)
+                it->second.bulk(bulkData(), argv, reply);
+            else
+                it->second.plain(argv, reply);
+        }
+        catch(const std::exception& e)
+        {
+            return raise(std::string(name) + ": " + e.what());
+        }
+        return reply.empty() ? nullptr : &reply[0];
+    }
+
+  private:
+    struct Entry
+    {
+        Handler     plain;
+        BulkHandler bulk;
+    };
+
+    // std::string_view como chave de busca, sem alocar
+    struct NameHash
+    {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const
+        {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+
+    using EntryTable = std::unordered_map<std::string,
+                                          Entry,
+                                          NameHash,
+                                          std::equal_to<>>;
+
+    MKernelVector                 kv;
+    ALGEB                         dataName = nullptr;
+    EntryTable                    handlers;
+    std::vector<std::string_view> argv;
+    std::string                   reply;
+
+    // try/finally: se o handler levantar erro, o _stream_data (que
+    // pode ter vários MB) não fica preso a uma variável global
+    void define(const std::string& name)
+    {
+        std::string src
+            = name
+              + " := proc(V) global _stream_data; local r;"
+                " try"
+                " _stream_data := `if`(type(V, rtable) and"
+                " rtable_options(V, 'datatype') = float[8]"
+                " and rtable_options(V, 'storage') = rectangular,"
+                " V, Vector(V, datatype = float[8]));"
+                " r := streamcall(INTERFACE_"
+              + name
+              + "(_rest))"
+                " finally unassign('_stream_data') end try;"
+                " r end proc:";
+        if(EvalMapleStatement(kv, src.c_str()) == nullptr)
+            throw std::runtime_error("stream: falha ao definir " + name);
+    }
+
+    std::span<const double> bulkData()
+    {
+        ALGEB rt = MapleEval(kv, dataName);
+        if(rt == nullptr || !IsMapleRTable(kv, rt))
+            throw std::invalid_argument("_stream_data não é RTable");
+
+        RTableSettings rts;
+        RTableGetSettings(kv, &rts, rt);
+        if(rts.data_type != RTABLE_FLOAT64
+           || rts.storage != RTABLE_RECT)
+            throw std::invalid_argument("esperava float[8] retangular");
+        return {static_cast<const double*>(RTableDataBlock(kv, rt)),
+                static_cast<size_t>(RTableNumElements(kv, rt))};
+    }
+
+    // `error "msg"` é analisado e avaliado pelo kernel no lugar do
+    // streamcall
+    char* raise(const std::string& msg)
+    {
+        reply = "error \"";
+        for(char c : msg)
+        {
+            if(c == '"' || c == '\\')
+                reply += '\\';
+            reply += c;
+        }
+        reply += "\";";
+        return &reply[0];
+    }
+};
+
+#endif /* STREAMS_HPP */
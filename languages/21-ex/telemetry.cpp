@@ -0,0 +1,68 @@
+/* telemetry.cpp - Memória, GC e CPU por comando (statusCallBack)
+ *
+ * Liga a telemetria do MapleKernel com gcfreq baixo (como o
+ * statusCallBack.c do 19-ex), avalia alguns comandos de perfis
+ * diferentes e exporta o resultado em:
+ *   telemetry.csv          uma linha por comando
+ *   telemetry_samples.csv  a série de status de cada comando
+ *   telemetry.json         os dois juntos
+ *   telemetry.prom         formato texto do Prometheus
+ *
+ * ./telemetry [gcfreq]   (padrão: 100000)
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "maple_kernel.hpp"
+
+int main(int argc, char* argv[])
+{
+    const long gcfreq = argc > 1 ? std::atol(argv[1]) : 100000;
+
+    try
+    {
+        MapleKernel      maple{1, argv};
+        KernelTelemetry& tm = maple.enableTelemetry(gcfreq);
+
+        const std::vector<std::string> commands = {
+            "int(1/(randpoly(x)^4+1), x):",
+            "L := [seq(i^2, i = 1..200000)]:",  // fica no heap
+            "add(i, i = L):",
+            "unassign('L'): gc():",
+            "LinearAlgebra:-Determinant(Matrix(8, (i,j) -> x^i+j)):",
+            "ifactor(2^128+1):",
+        };
+        for(const auto& cmd : commands)
+            maple.executeCommand(cmd);
+
+        std::cout << "\n=== gcfreq = " << gcfreq << " ===\n";
+        for(const auto& s : tm.statements())
+        {
+            std::cout << "#" << s.id << " " << s.wallMs << " ms, cpu "
+                      << s.cpuSec << " s, alloc "
+                      << s.allocDelta / 1024 << " kB, used "
+                      << s.usedDelta / 1024 << " kB, " << s.gcCount
+                      << " GCs, " << s.samples.size()
+                      << " status  " << s.label << "\n";
+        }
+
+        std::ofstream csv("telemetry.csv");
+        tm.writeCsv(csv);
+        std::ofstream samples("telemetry_samples.csv");
+        tm.writeSamplesCsv(samples);
+        std::ofstream json("telemetry.json");
+        tm.writeJson(json);
+        tm.writePrometheusFile("telemetry.prom");
+        std::cout << "telemetry.{csv,json,prom} e "
+                     "telemetry_samples.csv gravados\n";
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "\nFATAL EXCEPTION: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
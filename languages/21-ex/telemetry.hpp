@@ -0,0 +1,354 @@
+/* telemetry.hpp - Memória, GC e CPU do kernel por comando
+ *
+ * O statusCallBack (ver 19-ex/statusCallBack.c) informa kilobytes
+ * usados/alocados e o tempo de CPU a cada coleta de lixo, mas os
+ * exemplos só imprimem esses números. O KernelTelemetry guarda, para
+ * cada comando avaliado pelo MapleKernel:
+ *   - a série de status recebidos durante a avaliação;
+ *   - deltas de bytesused/bytesalloc, número de GCs e CPU, lidos de
+ *     kernelopts antes e depois (mais precisos que os status, que só
+ *     chegam quando há coleta);
+ * e exporta tudo em CSV, JSON ou no formato texto do Prometheus
+ * (node_exporter --collector.textfile), para ajustar o gcfreq e achar
+ * comandos que incham o heap em kernels de longa duração.
+ */
+
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "maplec.h"
+
+class KernelTelemetry
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    // Um statusCallBack
+    struct Sample
+    {
+        double t;        // ms desde o início do comando
+        long   kbUsed;   // kilobytesUsed
+        long   kbAlloc;  // kilobytesAlloc
+        double cpu;      // cpuTime (s, acumulado do kernel)
+    };
+
+    struct Statement
+    {
+        uint64_t            id;
+        std::string         label;       // comando (truncado)
+        double              wallMs;      // tempo de parede
+        double              cpuSec;      // delta de kernelopts(cputime)
+        long long           usedDelta;   // delta de bytesused
+        long long           allocDelta;  // delta de bytesalloc
+        long                gcCount;     // delta de gctimes
+        std::vector<Sample> samples;     // status durante o comando
+    };
+
+    // Guarda os últimos `maxStatements` comandos; os totais do
+    // Prometheus continuam contando os descartados
+    explicit KernelTelemetry(MKernelVector k,
+                             size_t        maxStatements = 10000)
+        : kv(k), limit(maxStatements)
+    {
+        attach();
+    }
+
+    ~KernelTelemetry()
+    {
+        detach();
+    }
+
+    KernelTelemetry(const KernelTelemetry&)            = delete;
+    KernelTelemetry& operator=(const KernelTelemetry&) = delete;
+
+    // Cria o procedimento que lê kernelopts; chamar de novo depois
+    // de um RestartMaple
+    void attach()
+    {
+        probe = EvalMapleStatement(
+            kv,
+            "proc() [kernelopts(bytesused), kernelopts(bytesalloc),"
+            " kernelopts(cputime), kernelopts(gctimes)] end proc:");
+        if(probe == nullptr)
+            throw std::runtime_error("telemetria: kernelopts falhou");
+        MapleGcProtect(kv, probe);
+    }
+
+    // Solta o procedimento; chamar antes do RestartMaple, enquanto
+    // o handle ainda é válido
+    void detach()
+    {
+        if(probe != nullptr)
+            MapleGcAllow(kv, probe);
+        probe = nullptr;
+    }
+
+    // MapleKernel::executeCommand chama begin/end em volta de cada
+    // comando; onStatus vem do statusCallBack
+    void begin(const std::string& command)
+    {
+        current       = Statement{};
+        current.id    = ++statementsTotal;
+        current.label = command.substr(0, 80);
+        startCounters = read();
+        startTime     = Clock::now();
+        inside        = true;
+    }
+
+    void end()
+    {
+        if(!inside)
+            return;
+        inside             = false;
+        current.wallMs     = msSince(startTime);
+        Counters c         = read();
+        current.usedDelta  = c.used - startCounters.used;
+        current.allocDelta = c.alloc - startCounters.alloc;
+        current.cpuSec     = c.cpu - startCounters.cpu;
+        current.gcCount    = c.gcs - startCounters.gcs;
+
+        wallTotal += current.wallMs / 1000.0;
+        cpuTotal += current.cpuSec;
+        gcTotal += current.gcCount;
+        bytesUsed  = c.used;
+        bytesAlloc = c.alloc;
+        if(current.allocDelta > maxAllocDelta)
+            maxAllocDelta = current.allocDelta;
+
+        history.push_back(std::move(current));
+        while(history.size() > limit)
+            history.pop_front();
+    }
+
+    void onStatus(long kbUsed, long kbAlloc, double cpu)
+    {
+        ++statusTotal;
+        if(inside)
+        {
+            current.samples.push_back(
+                {msSince(startTime), kbUsed, kbAlloc, cpu});
+        }
+    }
+
+    const std::deque<Statement>& statements() const
+    {
+        return history;
+    }
+
+    void clear()
+    {
+        history.clear();
+    }
+
+    // Uma linha por comando
+    void writeCsv(std::ostream& os) const
+    {
+        os << "id,statement,wall_ms,cpu_s,bytes_used_delta,"
+              "bytes_alloc_delta,gc_count,status_samples\n";
+        for(const auto& s : history)
+        {
+            os << s.id << ',' << csvQuote(s.label) << ',' << s.wallMs
+               << ',' << s.cpuSec << ',' << s.usedDelta << ','
+               << s.allocDelta << ',' << s.gcCount << ','
+               << s.samples.size() << '\n';
+        }
+    }
+
+    // A série de status de todos os comandos (id liga ao writeCsv)
+    void writeSamplesCsv(std::ostream& os) const
+    {
+        os << "id,t_ms,kb_used,kb_alloc,cpu_s\n";
+        for(const auto& s : history)
+        {
+            for(const auto& p : s.samples)
+            {
+                os << s.id << ',' << p.t << ',' << p.kbUsed << ','
+                   << p.kbAlloc << ',' << p.cpu << '\n';
+            }
+        }
+    }
+
+    void writeJson(std::ostream& os) const
+    {
+        os << "[";
+        for(size_t i = 0; i < history.size(); ++i)
+        {
+            const auto& s = history[i];
+            os << (i > 0 ? ",\n " : "\n ") << "{\"id\": " << s.id
+               << ", \"statement\": " << jsonQuote(s.label)
+               << ", \"wall_ms\": " << s.wallMs
+               << ", \"cpu_s\": " << s.cpuSec
+               << ", \"bytes_used_delta\": " << s.usedDelta
+               << ", \"bytes_alloc_delta\": " << s.allocDelta
+               << ", \"gc_count\": " << s.gcCount
+               << ", \"samples\": [";
+            for(size_t j = 0; j < s.samples.size(); ++j)
+            {
+                const auto& p = s.samples[j];
+                os << (j > 0 ? ", " : "") << "[" << p.t << ", "
+                   << p.kbUsed << ", " << p.kbAlloc << ", " << p.cpu
+                   << "]";
+            }
+            os << "]}";
+        }
+        os << "\n]\n";
+    }
+
+    void writePrometheus(std::ostream& os) const
+    {
+        metric(os,
+               "maple_statements_total",
+               "counter",
+               "Comandos avaliados",
+               static_cast<double>(statementsTotal));
+        metric(os,
+               "maple_statement_wall_seconds_total",
+               "counter",
+               "Tempo de parede somado dos comandos",
+               wallTotal);
+        metric(os,
+               "maple_cpu_seconds_total",
+               "counter",
+               "CPU do kernel somada dos comandos",
+               cpuTotal);
+        metric(os,
+               "maple_gc_total",
+               "counter",
+               "Coletas de lixo durante os comandos",
+               static_cast<double>(gcTotal));
+        metric(os,
+               "maple_status_callbacks_total",
+               "counter",
+               "Chamadas do statusCallBack",
+               static_cast<double>(statusTotal));
+        metric(os,
+               "maple_bytes_used",
+               "gauge",
+               "kernelopts(bytesused) no fim do último comando",
+               static_cast<double>(bytesUsed));
+        metric(os,
+               "maple_bytes_alloc",
+               "gauge",
+               "kernelopts(bytesalloc) no fim do último comando",
+               static_cast<double>(bytesAlloc));
+        metric(os,
+               "maple_statement_alloc_delta_max_bytes",
+               "gauge",
+               "Maior crescimento de bytesalloc num só comando",
+               static_cast<double>(maxAllocDelta));
+    }
+
+    // Grava em `path` de forma atômica (tmp + rename), como o
+    // coletor textfile espera
+    void writePrometheusFile(const std::string& path) const
+    {
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream f(tmp);
+            if(!f)
+                throw std::runtime_error("telemetria: " + tmp);
+            writePrometheus(f);
+        }
+        if(std::rename(tmp.c_str(), path.c_str()) != 0)
+            throw std::runtime_error("telemetria: rename " + path);
+    }
+
+  private:
+    struct Counters
+    {
+        long long used  = 0;
+        long long alloc = 0;
+        double    cpu   = 0.0;
+        long      gcs   = 0;
+    };
+
+    MKernelVector kv;
+    ALGEB         probe = nullptr;
+    size_t        limit;
+
+    std::deque<Statement> history;
+    Statement             current;
+    Counters              startCounters;
+    Clock::time_point     startTime;
+    bool                  inside = false;
+
+    uint64_t  statementsTotal = 0;
+    uint64_t  statusTotal     = 0;
+    long      gcTotal         = 0;
+    double    wallTotal       = 0.0;
+    double    cpuTotal        = 0.0;
+    long long bytesUsed       = 0;
+    long long bytesAlloc      = 0;
+    long long maxAllocDelta   = 0;
+
+    static double msSince(Clock::time_point t0)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now()
+                                                         - t0)
+            .count();
+    }
+
+    Counters read()
+    {
+        Counters c;
+        ALGEB    r = EvalMapleProc(kv, probe, 0);
+        if(r == nullptr || !IsMapleList(kv, r))
+            return c;
+        c.used  = MapleToInteger64(kv, MapleListSelect(kv, r, 1));
+        c.alloc = MapleToInteger64(kv, MapleListSelect(kv, r, 2));
+        c.cpu   = MapleToFloat64(kv, MapleListSelect(kv, r, 3));
+        c.gcs   = MapleToInteger32(kv, MapleListSelect(kv, r, 4));
+        return c;
+    }
+
+    static void metric(std::ostream& os,
+                       const char*   name,
+                       const char*   type,
+                       const char*   help,
+                       double        value)
+    {
+        os << "# HELP " << name << " " << help << "\n"
+           << "# TYPE " << name << " " << type << "\n"
+           << name << " " << value << "\n";
+    }
+
+    static std::string csvQuote(const std::string& s)
+    {
+        std::string out = "\"";
+        for(char c : s)
+        {
+            if(c == '"')
+                out += '"';
+            out += c == '\n' ? ' ' : c;
+        }
+        return out + "\"";
+    }
+
+    static std::string jsonQuote(const std::string& s)
+    {
+        std::string out = "\"";
+        for(char c : s)
+        {
+            if(c == '"' || c == '\\')
+                out += '\\';
+            if(c == '\n')
+                out += "\\n";
+            else if(static_cast<unsigned char>(c) < 0x20)
+                out += ' ';
+            else
+                out += c;
+        }
+        return out + "\"";
+    }
+};
+
+#endif /* TELEMETRY_HPP */
@@ -0,0 +1,100 @@
+/* views.cpp - Arrays grandes C++ <-> Maple: texto x RTable sem cópia
+ *
+ * Aplica sin() a N doubles no Maple e soma o resultado em C++ de
+ * duas formas:
+ *   1. texto: monta "Vector([...])", lê de volta convert(.., string)
+ *   2. MapleKernel::wrap(std::span) + MapleKernel::view<double>:
+ *      o Maple lê a memória do std::vector e o C++ lê o bloco de
+ *      dados do Vector devolvido, sem imprimir nem analisar nada
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "maple_kernel.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0)
+        .count();
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t N = argc > 1 ? std::strtoul(argv[1], nullptr, 10)
+                              : 1u << 18;
+
+    std::vector<double> xs(N);
+    for(size_t i = 0; i < N; ++i)
+        xs[i] = 1e-3 * static_cast<double>(i);
+
+    try
+    {
+        MapleKernel maple{1, argv};
+
+        PreparedStatement to_list = maple.prepare("convert(?, list)");
+        PreparedStatement sin_map = maple.prepare("map(sin, ?)");
+
+        // --- 1. texto nos dois sentidos ---
+        auto        t0 = Clock::now();
+        std::string cmd;
+        cmd.reserve(N * 24);
+        cmd = "map(sin, Vector([";
+        for(size_t i = 0; i < N; ++i)
+        {
+            if(i > 0)
+                cmd += ',';
+            cmd += std::to_string(xs[i]);
+        }
+        cmd += "], datatype = float[8])):";
+        std::string text
+            = maple.toString(to_list(maple.executeCommand(cmd)));
+
+        double      sum_text = 0.0;
+        const char* p        = text.c_str();
+        while(*p != '\0')
+        {
+            char*  q = nullptr;
+            double v = std::strtod(p + 1, &q);  // pula '[' ou ','
+            if(q == p + 1)
+                break;
+            sum_text += v;
+            p = q;
+        }
+        double ms_text = msSince(t0);
+
+        // --- 2. zero-copy ---
+        t0 = Clock::now();
+        RTableView<double> in = maple.wrap(std::span<double>(xs));
+        RTableView<double> out
+            = maple.view<double>(sin_map(in.algeb()));
+        double sum_view = std::accumulate(out.begin(), out.end(), 0.0);
+        double ms_view  = msSince(t0);
+
+        double sum_ref = 0.0;
+        for(double x : xs)
+            sum_ref += std::sin(x);
+
+        std::cout << "\n=== sin() em " << N << " doubles ===\n";
+        std::cout << "texto (Vector([...]) + string): " << ms_text
+                  << " ms  (soma " << sum_text << ")\n";
+        std::cout << "wrap(span) + view<double>:      " << ms_view
+                  << " ms  (soma " << sum_view << ")\n";
+        std::cout << "referência C++:                 soma "
+                  << sum_ref << "\n";
+        std::cout << "resultado: " << out.rows() << " x " << out.cols()
+                  << ", out.at(1) = " << out.at(1) << "\n";
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "\nFATAL EXCEPTION: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
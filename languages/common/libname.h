@@ -0,0 +1,383 @@
+/* libname.h - Descoberta do libname uma vez, com cache em disco (C)
+ *
+ * Cada exemplo configurava o libname do seu jeito: caminho fixo
+ * (/opt/maple2021/lib), $MAPLE/$MAPLE_ROOT com malloc (14-ex e os
+ * line.c de 15-ex a 17-ex) ou avaliar, falhar e tentar de novo
+ * (16-ex). Este header faz isso num lugar só, em C, para os exemplos
+ * em C e para o LibnameResolver do 21-ex/libname.hpp:
+ *
+ *   1. candidatos: $MAPLE/lib, $MAPLE_ROOT/lib, /opt/maple2021/lib
+ *      e /opt/maple* /lib (maior versão numérica primeiro);
+ *   2. o primeiro diretório com algum .mla válido (arquivo regular,
+ *      legível, não vazio) vence; diretórios extras vêm de
+ *      $MAPLE_LIBNAME_EXTRA (separados por ':');
+ *   3. o resultado vai para o cache ($MAPLE_LIBNAME_CACHE, ou
+ *      $XDG_CACHE_HOME/maple-libname, ou ~/.cache/maple-libname)
+ *      com os valores de $MAPLE, $MAPLE_ROOT e $MAPLE_LIBNAME_EXTRA
+ *      e o mtime de cada diretório.
+ *
+ * Nas partidas seguintes basta ler o cache e conferir o ambiente e
+ * os mtimes (um stat por diretório); qualquer diferença faz a
+ * descoberta rodar de novo.
+ *
+ *   #include "../common/libname.h"
+ *   maple_libname_apply(kv);   logo depois do StartMaple
+ */
+
+#ifndef MAPLE_LIBNAME_H
+#define MAPLE_LIBNAME_H
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "maplec.h"
+
+#define MAPLE_LIBNAME_MAX 8     /* diretórios no libname */
+#define MAPLE_LIBNAME_LEN 1024  /* tamanho de cada caminho */
+#define MAPLE_LIBNAME_DEFAULT "/opt/maple2021/lib"
+#define MAPLE_LIBNAME_STMT \
+    ((2 * MAPLE_LIBNAME_LEN + 4) * MAPLE_LIBNAME_MAX + 32)
+
+typedef struct
+{
+    int  n;
+    char dir[MAPLE_LIBNAME_MAX][MAPLE_LIBNAME_LEN];
+} MapleLibname;
+
+static inline const char* maple_libname_env(const char* name)
+{
+    const char* v = getenv(name);
+    return v != NULL ? v : "";
+}
+
+/* Caminho do cache em `out`; 0 se não há onde gravar */
+static inline int maple_libname_cache_path(char* out, size_t cap)
+{
+    const char* p = maple_libname_env("MAPLE_LIBNAME_CACHE");
+    int         n;
+    if(*p)
+        n = snprintf(out, cap, "%s", p);
+    else if(*(p = maple_libname_env("XDG_CACHE_HOME")))
+        n = snprintf(out, cap, "%s/maple-libname", p);
+    else if(*(p = maple_libname_env("HOME")))
+        n = snprintf(out, cap, "%s/.cache/maple-libname", p);
+    else
+        return 0;
+    return n > 0 && (size_t)n < cap;
+}
+
+/* Algum .mla regular, legível e não vazio */
+static inline int maple_libname_valid(const char* dir)
+{
+    DIR*           d = opendir(dir);
+    struct dirent* e;
+    int            ok = 0;
+    if(d == NULL)
+        return 0;
+
+    while(!ok && (e = readdir(d)) != NULL)
+    {
+        char        path[MAPLE_LIBNAME_LEN];
+        struct stat st;
+        size_t      len = strlen(e->d_name);
+        if(len < 5 || strcmp(e->d_name + len - 4, ".mla") != 0)
+            continue;
+        if(snprintf(path, sizeof path, "%s/%s", dir, e->d_name)
+           >= (int)sizeof path)
+            continue;
+        ok = stat(path, &st) == 0 && S_ISREG(st.st_mode)
+             && st.st_size > 0 && access(path, R_OK) == 0;
+    }
+    closedir(d);
+    return ok;
+}
+
+static inline long long maple_libname_mtime(const char* dir)
+{
+    struct stat st;
+    if(stat(dir, &st) != 0 || !S_ISDIR(st.st_mode))
+        return -1;
+    return (long long)st.st_mtime;
+}
+
+/* Acrescenta `dir` (sem repetir); 0 se não coube */
+static inline int maple_libname_add(MapleLibname* l, const char* dir)
+{
+    int i;
+    for(i = 0; i < l->n; ++i)
+    {
+        if(strcmp(l->dir[i], dir) == 0)
+            return 1;
+    }
+    if(l->n == MAPLE_LIBNAME_MAX || strlen(dir) >= MAPLE_LIBNAME_LEN)
+        return 0;
+    strcpy(l->dir[l->n++], dir);
+    return 1;
+}
+
+/* Primeiras linhas do cache: versão e o ambiente que o produziu */
+static inline int maple_libname_header(char* out, size_t cap)
+{
+    int n = snprintf(out,
+                     cap,
+                     "maple-libname 2\nMAPLE=%s\nMAPLE_ROOT=%s\n"
+                     "MAPLE_LIBNAME_EXTRA=%s\n",
+                     maple_libname_env("MAPLE"),
+                     maple_libname_env("MAPLE_ROOT"),
+                     maple_libname_env("MAPLE_LIBNAME_EXTRA"));
+    return n > 0 && (size_t)n < cap;
+}
+
+/* Grava via tmp + rename para não deixar cache pela metade */
+static inline void maple_libname_save(const MapleLibname* l)
+{
+    char  path[MAPLE_LIBNAME_LEN], tmp[MAPLE_LIBNAME_LEN + 32];
+    char  header[4 * MAPLE_LIBNAME_LEN];
+    char* slash;
+    FILE* f;
+    int   i;
+
+    if(!maple_libname_cache_path(path, sizeof path)
+       || !maple_libname_header(header, sizeof header))
+        return;
+    if((slash = strrchr(path, '/')) != NULL && slash != path)
+    {
+        *slash = '\0';
+        mkdir(path, 0755);
+        *slash = '/';
+    }
+
+    snprintf(tmp, sizeof tmp, "%s.%ld", path, (long)getpid());
+    if((f = fopen(tmp, "w")) == NULL)
+        return;
+    fputs(header, f);
+    for(i = 0; i < l->n; ++i)
+        fprintf(f,
+                "%lld %s\n",
+                maple_libname_mtime(l->dir[i]),
+                l->dir[i]);
+    if(fclose(f) != 0 || rename(tmp, path) != 0)
+        remove(tmp);
+}
+
+/* Lê o cache; 0 se faltar, se o ambiente mudou ou se algum mtime
+ * não confere (o cache inteiro é descartado) */
+static inline int maple_libname_load(MapleLibname* l)
+{
+    char   path[MAPLE_LIBNAME_LEN];
+    char   header[4 * MAPLE_LIBNAME_LEN];
+    char   line[MAPLE_LIBNAME_LEN + 32];
+    size_t hlen;
+    FILE*  f;
+
+    l->n = 0;
+    if(!maple_libname_cache_path(path, sizeof path)
+       || !maple_libname_header(header, sizeof header)
+       || (f = fopen(path, "r")) == NULL)
+        return 0;
+
+    /* o cabeçalho tem de bater byte a byte */
+    hlen = strlen(header);
+    {
+        char   got[4 * MAPLE_LIBNAME_LEN];
+        size_t n = fread(got, 1, hlen, f);
+        if(n != hlen || memcmp(got, header, hlen) != 0)
+        {
+            fclose(f);
+            return 0;
+        }
+    }
+
+    while(fgets(line, sizeof line, f) != NULL)
+    {
+        char*     sp  = strchr(line, ' ');
+        size_t    len = strlen(line);
+        long long mt;
+        if(sp == NULL || len == 0 || line[len - 1] != '\n')
+            break;
+        line[len - 1] = '\0';
+        *sp           = '\0';
+        mt            = atoll(line);
+        if(mt != maple_libname_mtime(sp + 1)
+           || !maple_libname_add(l, sp + 1))
+            break;
+    }
+    if(!feof(f))
+        l->n = 0;
+    fclose(f);
+    return l->n;
+}
+
+/* "/opt/maple2021.1/lib" -> 2021 e 1; -1 onde não houver número */
+static inline void maple_libname_version(const char* dir,
+                                         long*       major,
+                                         long*       minor)
+{
+    const char* p = dir + sizeof "/opt/maple" - 1;
+    char*       end;
+    *major = *minor = -1;
+    if(!isdigit((unsigned char)*p))
+        return;
+    *major = strtol(p, &end, 10);
+    if(*end == '.' && isdigit((unsigned char)end[1]))
+        *minor = strtol(end + 1, NULL, 10);
+}
+
+/* Versão numérica decrescente: maple2021.1, maple2021, maple9 e só
+ * então os nomes sem número */
+static inline int maple_libname_cmp_desc(const void* a, const void* b)
+{
+    long amaj, amin, bmaj, bmin;
+    maple_libname_version((const char*)a, &amaj, &amin);
+    maple_libname_version((const char*)b, &bmaj, &bmin);
+    if(amaj != bmaj)
+        return amaj < bmaj ? 1 : -1;
+    if(amin != bmin)
+        return amin < bmin ? 1 : -1;
+    return strcmp((const char*)b, (const char*)a);
+}
+
+/* Descobre de novo (ignorando o cache) e regrava o cache */
+static inline int maple_libname_discover(MapleLibname* l)
+{
+    char        cand[32][MAPLE_LIBNAME_LEN];
+    int         nc = 0, nopt, i;
+    const char* v;
+    DIR*        d;
+
+    l->n = 0;
+    if(*(v = maple_libname_env("MAPLE")))
+        snprintf(cand[nc++], MAPLE_LIBNAME_LEN, "%s/lib", v);
+    if(*(v = maple_libname_env("MAPLE_ROOT")))
+        snprintf(cand[nc++], MAPLE_LIBNAME_LEN, "%s/lib", v);
+    snprintf(
+        cand[nc++], MAPLE_LIBNAME_LEN, "%s", MAPLE_LIBNAME_DEFAULT);
+
+    nopt = nc;
+    if((d = opendir("/opt")) != NULL)
+    {
+        struct dirent* e;
+        while(nc < 32 && (e = readdir(d)) != NULL)
+        {
+            if(strncmp(e->d_name, "maple", 5) == 0)
+                snprintf(cand[nc++],
+                         MAPLE_LIBNAME_LEN,
+                         "/opt/%s/lib",
+                         e->d_name);
+        }
+        closedir(d);
+    }
+    /* /opt/maple*: mais nova primeiro */
+    qsort(cand[nopt],
+          (size_t)(nc - nopt),
+          MAPLE_LIBNAME_LEN,
+          maple_libname_cmp_desc);
+
+    for(i = 0; i < nc && l->n == 0; ++i)
+    {
+        if(maple_libname_valid(cand[i]))
+            maple_libname_add(l, cand[i]);
+    }
+    if(l->n == 0)
+        return 0;
+
+    v = maple_libname_env("MAPLE_LIBNAME_EXTRA");
+    while(*v)
+    {
+        char   dir[MAPLE_LIBNAME_LEN];
+        size_t len = strcspn(v, ":");
+        if(len > 0 && len < sizeof dir)
+        {
+            memcpy(dir, v, len);
+            dir[len] = '\0';
+            if(maple_libname_valid(dir))
+                maple_libname_add(l, dir);
+        }
+        v += len;
+        if(*v == ':')
+            ++v;
+    }
+    maple_libname_save(l);
+    return l->n;
+}
+
+/* Cache se válido, senão descoberta; devolve o número de diretórios
+ * (0: nenhum Maple encontrado) */
+static inline int maple_libname_resolve(MapleLibname* l)
+{
+    return maple_libname_load(l) > 0 ? l->n : maple_libname_discover(l);
+}
+
+/* "dir", com \ e " escapados, em out + *used; 0 se não coube */
+static inline int maple_libname_quote(char*       out,
+                                      size_t      cap,
+                                      size_t*     used,
+                                      const char* dir)
+{
+    size_t u = *used;
+    if(u + 1 >= cap)
+        return 0;
+    out[u++] = '"';
+    for(; *dir; ++dir)
+    {
+        if(u + 2 >= cap)
+            return 0;
+        if(*dir == '"' || *dir == '\\')
+            out[u++] = '\\';
+        out[u++] = *dir;
+    }
+    if(u + 1 >= cap)
+        return 0;
+    out[u++] = '"';
+    out[u]   = '\0';
+    *used    = u;
+    return 1;
+}
+
+/* libname := "a", "b", libname: — com MAPLE_LIBNAME_DEFAULT se `l`
+ * estiver vazio. 0 se não coube em `out`. */
+static inline int maple_libname_statement(const MapleLibname* l,
+                                          char*               out,
+                                          size_t              cap)
+{
+    size_t used = 0;
+    int    i, n;
+
+    n = snprintf(out, cap, "libname := ");
+    if(n < 0 || (size_t)n >= cap)
+        return 0;
+    used = (size_t)n;
+    for(i = 0; i < (l->n > 0 ? l->n : 1); ++i)
+    {
+        if(!maple_libname_quote(
+               out,
+               cap,
+               &used,
+               l->n > 0 ? l->dir[i] : MAPLE_LIBNAME_DEFAULT))
+            return 0;
+        n = snprintf(out + used, cap - used, ", ");
+        if(n < 0 || (size_t)n >= cap - used)
+            return 0;
+        used += (size_t)n;
+    }
+    n = snprintf(out + used, cap - used, "libname:");
+    return n > 0 && (size_t)n < cap - used;
+}
+
+/* Resolve e avalia o libname no kernel; devolve o número de
+ * diretórios encontrados (0: usou MAPLE_LIBNAME_DEFAULT) */
+static inline int maple_libname_apply(MKernelVector kv)
+{
+    MapleLibname l;
+    char         stmt[MAPLE_LIBNAME_STMT];
+    int          n = maple_libname_resolve(&l);
+    if(maple_libname_statement(&l, stmt, sizeof stmt))
+        EvalMapleStatement(kv, stmt);
+    return n;
+}
+
+#endif /* MAPLE_LIBNAME_H */